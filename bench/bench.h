@@ -0,0 +1,25 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+// Keeps the compiler from optimizing away a computed value.
+template <typename T>
+void DoNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Runs `body` once and prints elapsed time and throughput for `ops` operations.
+template <typename F>
+double RunBenchmark(const std::string& name, size_t ops, F&& body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    auto finish = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(finish - start).count();
+    std::cout << name << ": " << seconds * 1e3 << " ms, " << ops / seconds / 1e6 << " Mops/s"
+              << std::endl;
+    return seconds;
+}
@@ -0,0 +1,95 @@
+#include "../src/arena/arena.h"
+#include "./bench.h"
+#include <vector>
+
+// Per-request object graph: shared, intrusive and unique objects that all die with the request.
+// Compares creating and tearing down requests on the heap and in an `Arena`.
+
+struct Header {
+    uint64_t key = 0;
+    uint64_t value = 0;
+};
+
+template <typename D>
+struct Token : SimpleRefCounted<Token<D>, D> {
+    explicit Token(uint64_t id) : id{id} {
+    }
+    uint64_t id;
+};
+
+constexpr size_t kRequests = 2'000;
+constexpr size_t kObjects = 1'000;
+
+int main() {
+    uint64_t sum = 0;
+
+    RunBenchmark("heap requests", kRequests * kObjects * 3, [&] {
+        for (size_t r = 0; r < kRequests; ++r) {
+            std::vector<SharedPtr<Header>> headers;
+            std::vector<IntrusivePtr<Token<DefaultDelete>>> tokens;
+            std::vector<UniquePtr<Header>> scratch;
+            headers.reserve(kObjects);
+            tokens.reserve(kObjects);
+            scratch.reserve(kObjects);
+            for (size_t i = 0; i < kObjects; ++i) {
+                headers.push_back(MakeShared<Header>());
+                tokens.push_back(MakeIntrusive<Token<DefaultDelete>>(i));
+                scratch.emplace_back(new Header);
+            }
+            sum += tokens.back()->id;
+        }
+    });
+
+    RunBenchmark("arena requests", kRequests * kObjects * 3, [&] {
+        for (size_t r = 0; r < kRequests; ++r) {
+            Arena arena;
+            std::vector<SharedPtr<Header>> headers;
+            std::vector<IntrusivePtr<Token<ArenaDelete>>> tokens;
+            std::vector<ArenaUniquePtr<Header>> scratch;
+            headers.reserve(kObjects);
+            tokens.reserve(kObjects);
+            scratch.reserve(kObjects);
+            for (size_t i = 0; i < kObjects; ++i) {
+                headers.push_back(MakeSharedIn<Header>(arena));
+                tokens.push_back(MakeIntrusiveIn<Token<ArenaDelete>>(arena, i));
+                scratch.push_back(MakeUniqueIn<Header>(arena));
+            }
+            sum += tokens.back()->id;
+        }
+    });
+
+    // Teardown only: the graph is built outside of the timed region
+    double heap = 0;
+    double arena_time = 0;
+    for (size_t r = 0; r < kRequests; ++r) {
+        std::vector<SharedPtr<Header>> headers;
+        std::vector<IntrusivePtr<Token<DefaultDelete>>> tokens;
+        for (size_t i = 0; i < kObjects; ++i) {
+            headers.push_back(MakeShared<Header>());
+            tokens.push_back(MakeIntrusive<Token<DefaultDelete>>(i));
+        }
+        auto start = std::chrono::steady_clock::now();
+        headers = {};
+        tokens = {};
+        heap += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        auto* arena = new Arena;
+        {
+            std::vector<SharedPtr<Header>> arena_headers;
+            std::vector<IntrusivePtr<Token<ArenaDelete>>> arena_tokens;
+            for (size_t i = 0; i < kObjects; ++i) {
+                arena_headers.push_back(MakeSharedIn<Header>(*arena));
+                arena_tokens.push_back(MakeIntrusiveIn<Token<ArenaDelete>>(*arena, i));
+            }
+            start = std::chrono::steady_clock::now();
+            arena_headers = {};
+            arena_tokens = {};
+            delete arena;
+        }
+        arena_time +=
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    std::cout << "teardown per request: heap " << heap / kRequests * 1e6 << " us, arena "
+              << arena_time / kRequests * 1e6 << " us" << std::endl;
+    DoNotOptimize(sum);
+}
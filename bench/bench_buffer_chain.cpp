@@ -0,0 +1,68 @@
+#include "../src/shared/buffer_chain.h"
+#include "./bench.h"
+#include <string>
+#include <unistd.h>
+
+// Pipe loopback: a message assembled from many segments is written and read back.
+// Baseline copies the segments into a `std::string` and uses write/read; the chain goes
+// through writev straight from the segments and reads into slices of a large shared block.
+
+constexpr size_t kSegmentSize = 1024;
+constexpr size_t kSegments = 32;  // 32 KiB per message, below the default pipe capacity
+constexpr size_t kMessageSize = kSegmentSize * kSegments;
+constexpr size_t kRounds = 50'000;
+constexpr size_t kReceiveBlockSize = 64 * kMessageSize;
+
+void ReadExactly(int fd, std::byte* data, size_t size) {
+    while (size > 0) {
+        ssize_t got = read(fd, data, size);
+        data += got;
+        size -= got;
+    }
+}
+
+int main() {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return 1;
+    }
+
+    SharedBytes payload = MakeSharedSpan<std::byte>(kSegmentSize * kSegments);
+    BufferChain message;
+    for (size_t i = 0; i < kSegments; ++i) {
+        message.Append(payload.Subspan(i * kSegmentSize, kSegmentSize));
+    }
+
+    RunBenchmark("copy into std::string", kRounds, [&] {
+        std::string in(kMessageSize, '\0');
+        for (size_t r = 0; r < kRounds; ++r) {
+            std::string out;
+            message.ForEachSegment([&out](const SharedBytes& bytes) {
+                out.append(reinterpret_cast<const char*>(bytes.Data()), bytes.Size());
+            });
+            ssize_t written = write(fds[1], out.data(), out.size());
+            ReadExactly(fds[0], reinterpret_cast<std::byte*>(in.data()), written);
+            DoNotOptimize(in);
+        }
+    });
+
+    RunBenchmark("BufferChain writev", kRounds, [&] {
+        SharedSpan<std::byte> block;
+        for (size_t r = 0; r < kRounds; ++r) {
+            BufferChain out = message.Clone();
+            std::vector<iovec> iov = out.ToIovecs();
+            size_t written = writev(fds[1], iov.data(), iov.size());
+
+            if (block.Size() < written) {
+                block = {MakeSharedForOverwrite<std::byte[]>(kReceiveBlockSize), kReceiveBlockSize};
+            }
+            ReadExactly(fds[0], block.Data(), written);
+            BufferChain in(block.First(written));
+            block = block.Subspan(written);
+            DoNotOptimize(in);
+        }
+    });
+
+    close(fds[0]);
+    close(fds[1]);
+}
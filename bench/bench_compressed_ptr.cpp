@@ -0,0 +1,81 @@
+#include "../src/arena/compressed_ptr.h"
+#include "../src/intrusive/intrusive.h"
+#include "./bench.h"
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// DAG with `kFanOut` edges per node: `IntrusivePtr` edges on the heap vs.
+// `CompressedIntrusivePtr` edges in a `CompressedArena`.
+// Usage: ./bench_compressed_ptr [edges], 100M edges by default.
+
+constexpr size_t kFanOut = 4;
+
+struct WideNode : SimpleRefCounted<WideNode> {
+    uint32_t value = 0;
+    IntrusivePtr<WideNode> edges[kFanOut];
+};
+
+struct CompactNode : SimpleRefCounted<CompactNode, CompressedArenaDelete> {
+    uint32_t value = 0;
+    CompressedIntrusivePtr<CompactNode> edges[kFanOut];
+};
+
+template <typename Node, typename Ptr, typename Make>
+void RunGraph(const std::string& name, size_t nodes, Make make) {
+    std::vector<Ptr> all;
+    all.reserve(nodes);
+    std::mt19937 gen(42);
+
+    RunBenchmark(name + ": build", nodes * kFanOut, [&] {
+        for (size_t i = 0; i < nodes; ++i) {
+            Ptr node = make();
+            node->value = i;
+            // Edges point backwards, so the graph has no cycles
+            for (size_t e = 0; e < kFanOut && i > 0; ++e) {
+                node->edges[e] = all[gen() % i];
+            }
+            all.push_back(std::move(node));
+        }
+    });
+
+    uint64_t sum = 0;
+    RunBenchmark(name + ": traverse", nodes * kFanOut, [&] {
+        for (size_t walk = 0; walk < nodes / 16; ++walk) {
+            Node* node = all[nodes - 1 - walk].Get();
+            for (size_t step = 0; step < 16 * kFanOut && node != nullptr; ++step) {
+                sum += node->value;
+                node = node->edges[step % kFanOut].Get();
+            }
+        }
+    });
+    DoNotOptimize(sum);
+
+    // Newest nodes first, so releasing one never cascades
+    RunBenchmark(name + ": destroy", nodes, [&] {
+        while (!all.empty()) {
+            all.pop_back();
+        }
+    });
+}
+
+int main(int argc, char** argv) {
+    size_t edges = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100'000'000;
+    size_t nodes = edges / kFanOut;
+
+    std::cout << "pointer size: IntrusivePtr " << sizeof(IntrusivePtr<WideNode>)
+              << " bytes, CompressedIntrusivePtr " << sizeof(CompressedIntrusivePtr<CompactNode>)
+              << " bytes" << std::endl;
+    std::cout << "node size: " << sizeof(WideNode) << " vs " << sizeof(CompactNode)
+              << " bytes, edges: " << nodes * kFanOut * sizeof(IntrusivePtr<WideNode>) / (1 << 20)
+              << " vs " << nodes * kFanOut * sizeof(CompressedIntrusivePtr<CompactNode>) / (1 << 20)
+              << " MiB" << std::endl;
+
+    RunGraph<WideNode, IntrusivePtr<WideNode>>("IntrusivePtr", nodes,
+                                                [] { return MakeIntrusive<WideNode>(); });
+
+    CompressedArena arena(nodes * sizeof(CompactNode) + (1 << 20));
+    RunGraph<CompactNode, CompressedIntrusivePtr<CompactNode>>(
+        "CompressedIntrusivePtr", nodes, [] { return MakeCompressedIntrusive<CompactNode>(); });
+    std::cout << "arena used: " << arena.Used() / (1 << 20) << " MiB" << std::endl;
+}
@@ -0,0 +1,44 @@
+#include "../src/shared/cow.h"
+#include "./bench.h"
+#include <vector>
+
+// Edit-heavy workload on a 1 MiB document with a read-only snapshot taken every `kSnapshotEvery`
+// edits: copying before every edit vs. `CowPtr::Mutate`, which copies only after a snapshot.
+
+struct Document {
+    std::vector<uint64_t> words = std::vector<uint64_t>(1 << 17);
+};
+
+constexpr size_t kEdits = 20'000;
+constexpr size_t kSnapshotEvery = 100;
+
+int main() {
+    std::vector<SharedPtr<const Document>> history;
+
+    RunBenchmark("copy on every edit", kEdits, [&] {
+        SharedPtr<const Document> current = MakeShared<Document>();
+        for (size_t i = 0; i < kEdits; ++i) {
+            SharedPtr<Document> edited = MakeShared<Document>(*current);
+            edited->words[i % edited->words.size()] += i;
+            current = edited;
+            if (i % kSnapshotEvery == 0) {
+                history.push_back(current);
+            }
+        }
+        DoNotOptimize(current->words[0]);
+    });
+    history.clear();
+
+    RunBenchmark("CowPtr::Mutate", kEdits, [&] {
+        CowPtr<Document> current;
+        for (size_t i = 0; i < kEdits; ++i) {
+            Document& edited = current.Mutate();
+            edited.words[i % edited.words.size()] += i;
+            if (i % kSnapshotEvery == 0) {
+                history.push_back(current.Share());
+            }
+        }
+        DoNotOptimize(current->words[0]);
+    });
+    std::cout << "  snapshots: " << history.size() << std::endl;
+}
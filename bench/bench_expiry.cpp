@@ -0,0 +1,76 @@
+#include "../src/weak/expiry.h"
+#include "./bench.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Secondary index over 10M live objects, 1% of which then die.
+// Sweeping scans every entry for expired `WeakPtr`s; with expiry callbacks every dying object
+// erases its own entry and nothing is scanned.
+
+constexpr size_t kObjects = 10'000'000;
+constexpr size_t kDieEvery = 100;
+
+int main() {
+    std::vector<SharedPtr<uint64_t>> objects;
+    objects.reserve(kObjects);
+    for (size_t i = 0; i < kObjects; ++i) {
+        objects.push_back(MakeShared<uint64_t>(i));
+    }
+
+    {
+        std::unordered_map<uint64_t, WeakPtr<uint64_t>> index;
+        index.reserve(kObjects);
+        RunBenchmark("sweep: build index", kObjects, [&] {
+            for (size_t i = 0; i < kObjects; ++i) {
+                index.emplace(i, WeakPtr<uint64_t>(objects[i]));
+            }
+        });
+        std::vector<SharedPtr<uint64_t>> dying;
+        for (size_t i = 0; i < kObjects; i += kDieEvery) {
+            dying.push_back(std::move(objects[i]));
+        }
+        RunBenchmark("sweep: objects die", dying.size(), [&] {
+            dying.clear();
+        });
+        RunBenchmark("sweep: scan index", kObjects, [&] {
+            std::erase_if(index, [](const auto& item) {
+                return item.second.Expired();
+            });
+        });
+        std::cout << "  entries: " << index.size() << std::endl;
+    }
+
+    for (size_t i = 0; i < kObjects; i += kDieEvery) {
+        objects[i] = MakeShared<uint64_t>(i);
+    }
+
+    {
+        struct Entry {
+            WeakPtr<uint64_t> object;
+            ExpirySubscription subscription;
+        };
+        std::unordered_map<uint64_t, Entry> index;
+        index.reserve(kObjects);
+        RunBenchmark("callbacks: build index", kObjects, [&] {
+            for (size_t i = 0; i < kObjects; ++i) {
+                Entry& entry = index[i];
+                entry.object = objects[i];
+                entry.subscription = OnExpired(objects[i], [&index, i] {
+                    // The subscription has fired, erasing it needs no registry lookup
+                    auto it = index.find(i);
+                    it->second.subscription.Release();
+                    index.erase(it);
+                });
+            }
+        });
+        std::vector<SharedPtr<uint64_t>> dying;
+        for (size_t i = 0; i < kObjects; i += kDieEvery) {
+            dying.push_back(std::move(objects[i]));
+        }
+        RunBenchmark("callbacks: objects die and erase their entries", dying.size(), [&] {
+            dying.clear();
+        });
+        std::cout << "  entries: " << index.size() << std::endl;
+    }
+}
@@ -0,0 +1,49 @@
+#include "../src/function/function.h"
+#include "../src/unique/unique.h"
+#include "./bench.h"
+#include <deque>
+#include <functional>
+#include <memory>
+
+// Task queue throughput: enqueue N callbacks, then dequeue and run them.
+// `std::function` cannot hold a `UniquePtr` capture, so it gets a `std::shared_ptr` instead.
+
+constexpr size_t kTasks = 10'000'000;
+
+template <typename Queue, typename MakeTask>
+void RunQueue(const std::string& name, MakeTask make_task) {
+    Queue queue;
+    size_t sum = 0;
+    RunBenchmark(name, kTasks, [&] {
+        for (size_t i = 0; i < kTasks; ++i) {
+            queue.push_back(make_task(i, sum));
+        }
+        while (!queue.empty()) {
+            queue.front()();
+            queue.pop_front();
+        }
+    });
+    DoNotOptimize(sum);
+}
+
+int main() {
+    RunQueue<std::deque<std::function<void()>>>(
+        "std::function, small capture", [](size_t i, size_t& sum) {
+            return std::function<void()>([i, &sum] { sum += i; });
+        });
+    RunQueue<std::deque<UniqueFunction<void()>>>(
+        "UniqueFunction, small capture", [](size_t i, size_t& sum) {
+            return UniqueFunction<void()>([i, &sum] { sum += i; });
+        });
+
+    RunQueue<std::deque<std::function<void()>>>(
+        "std::function, shared_ptr capture", [](size_t i, size_t& sum) {
+            return std::function<void()>(
+                [p = std::make_shared<size_t>(i), &sum] { sum += *p; });
+        });
+    RunQueue<std::deque<UniqueFunction<void()>>>(
+        "UniqueFunction, UniquePtr capture", [](size_t i, size_t& sum) {
+            return UniqueFunction<void()>(
+                [p = UniquePtr<size_t>(new size_t(i)), &sum] { sum += *p; });
+        });
+}
@@ -0,0 +1,63 @@
+#include "../src/unique/unique_array.h"
+#include "./bench.h"
+#include <fstream>
+#include <random>
+#include <sstream>
+
+// Dependent random reads over a 1 GiB table: regular 64-byte aligned allocation vs.
+// huge-page backed `UniqueArray<T, kHugePageSize>`. TLB misses dominate the former.
+
+constexpr size_t kElements = (1 << 30) / sizeof(uint64_t);
+constexpr size_t kReads = 20'000'000;
+
+// Share of the mapping containing `ptr` backed by transparent huge pages, from /proc/self/smaps
+std::string EffectivePageSize(const void* ptr) {
+    auto address = reinterpret_cast<uintptr_t>(ptr);
+    std::ifstream smaps("/proc/self/smaps");
+    std::string line;
+    bool inside = false;
+    size_t size_kb = 0;
+    while (std::getline(smaps, line)) {
+        uintptr_t begin = 0, end = 0;
+        char dash = 0;
+        std::istringstream header(line);
+        if (header >> std::hex >> begin >> dash >> end && dash == '-') {
+            inside = begin <= address && address < end;
+            continue;
+        }
+        std::istringstream field(line);
+        std::string name;
+        size_t value_kb = 0;
+        field >> name >> value_kb;
+        if (inside && name == "Size:") {
+            size_kb = value_kb;
+        } else if (inside && name == "AnonHugePages:") {
+            return value_kb * 2 >= size_kb ? "2 MiB (" + std::to_string(value_kb) + " kB THP)"
+                                           : "4 KiB (" + std::to_string(value_kb) + " kB THP)";
+        }
+    }
+    return "unknown";
+}
+
+template <size_t Align>
+void RunRandomReads(const std::string& name) {
+    UniqueArray<uint64_t, Align> table = UniqueArray<uint64_t, Align>::Uninitialized(kElements);
+    std::mt19937_64 rng(42);
+    for (uint64_t& next : table) {
+        next = rng() % kElements;
+    }
+
+    std::cout << name << " page size: " << EffectivePageSize(table.Data()) << std::endl;
+    uint64_t index = 0;
+    RunBenchmark(name + ", dependent random reads", kReads, [&] {
+        for (size_t i = 0; i < kReads; ++i) {
+            index = table[index];
+        }
+    });
+    DoNotOptimize(index);
+}
+
+int main() {
+    RunRandomReads<kDefaultArrayAlignment>("UniqueArray<uint64_t>");
+    RunRandomReads<kHugePageSize>("UniqueArray<uint64_t, kHugePageSize>");
+}
@@ -0,0 +1,74 @@
+#include "../src/shared/interner.h"
+#include "./bench.h"
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Loads 2M records whose 48-byte schema strings are drawn from 20k distinct values with a skew,
+// then measures interning throughput on hits (all values alive) and after the values died
+// (every probe finds expired entries to purge and reinserts).
+
+constexpr size_t kRecords = 2'000'000;
+constexpr size_t kDistinct = 20'000;
+
+int main() {
+    std::mt19937_64 gen(42);
+    std::vector<std::string> values;
+    for (size_t i = 0; i < kDistinct; ++i) {
+        values.push_back("schema/" + std::to_string(i) + "/" + std::string(32, 'a' + i % 26));
+    }
+    // Squaring a uniform draw favours small ids, like popular schemas
+    std::vector<size_t> ids(kRecords);
+    for (size_t& id : ids) {
+        double u = std::uniform_real_distribution<double>(0, 1)(gen);
+        id = static_cast<size_t>(u * u * kDistinct);
+    }
+
+    std::vector<SharedPtr<const std::string>> records;
+    records.reserve(kRecords);
+    RunBenchmark("MakeShared per record", kRecords, [&] {
+        for (size_t id : ids) {
+            records.push_back(MakeShared<std::string>(values[id]));
+        }
+    });
+    records.clear();
+
+    Interner<std::string> interner;
+    RunBenchmark("Interner::Intern", kRecords, [&] {
+        for (size_t id : ids) {
+            records.push_back(interner.Intern(values[id]));
+        }
+    });
+    size_t distinct = interner.EntryCount();
+    std::cout << "  instances: " << distinct << " for " << kRecords << " records, dedup ratio "
+              << static_cast<double>(kRecords) / distinct << std::endl;
+    std::cout << "  payload: " << kRecords * values[0].size() / 1024 / 1024 << " MiB -> "
+              << distinct * values[0].size() / 1024 << " KiB" << std::endl;
+
+    RunBenchmark("Interner::Intern, hits", kRecords, [&] {
+        for (size_t id : ids) {
+            DoNotOptimize(interner.Intern(values[id]).Get());
+        }
+    });
+
+    // A strong table for comparison: the same lookups, but it never lets a value die
+    std::unordered_map<std::string, SharedPtr<const std::string>> strong;
+    for (const auto& record : records) {
+        strong.emplace(*record, record);
+    }
+    RunBenchmark("unordered_map<string, SharedPtr>, hits", kRecords, [&] {
+        for (size_t id : ids) {
+            DoNotOptimize(strong.find(values[id])->second.Get());
+        }
+    });
+    strong.clear();
+
+    records.clear();
+    RunBenchmark("Interner::Intern, after the values died", kRecords, [&] {
+        for (size_t id : ids) {
+            records.push_back(interner.Intern(values[id]));
+        }
+    });
+    std::cout << "  entries: " << interner.EntryCount() << std::endl;
+}
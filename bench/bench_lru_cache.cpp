@@ -0,0 +1,107 @@
+#include "../src/shared/lru_cache.h"
+#include "./bench.h"
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+// Zipfian (s = 0.99) requests over 1M keys of 256-byte values, the cache holds 5% of the bytes.
+// A miss loads the value and puts it in. The caller keeps the last `kHeld` values alive, so some
+// evicted values are still held when requested again and come back without a load.
+// Compared with a strict LRU (list + map, one lock-free shard) on the same trace.
+
+constexpr size_t kKeys = 1'000'000;
+constexpr size_t kRequests = 5'000'000;
+constexpr size_t kValueSize = 256;
+constexpr size_t kCapacity = kKeys * kValueSize / 20;
+constexpr size_t kHeld = 1'000'000;
+
+struct Value {
+    char bytes[kValueSize];
+};
+
+std::vector<uint32_t> ZipfTrace() {
+    std::vector<double> cdf(kKeys);
+    double sum = 0;
+    for (size_t i = 0; i < kKeys; ++i) {
+        sum += 1 / std::pow(i + 1.0, 0.99);
+        cdf[i] = sum;
+    }
+    std::mt19937_64 gen(42);
+    std::uniform_real_distribution<double> uniform(0, sum);
+    std::vector<uint32_t> trace(kRequests);
+    for (uint32_t& key : trace) {
+        key = std::lower_bound(cdf.begin(), cdf.end(), uniform(gen)) - cdf.begin();
+    }
+    // Popular keys should not all be small numbers
+    std::vector<uint32_t> permutation(kKeys);
+    for (size_t i = 0; i < kKeys; ++i) {
+        permutation[i] = i;
+    }
+    std::shuffle(permutation.begin(), permutation.end(), gen);
+    for (uint32_t& key : trace) {
+        key = permutation[key];
+    }
+    return trace;
+}
+
+class StrictLru {
+public:
+    SharedPtr<Value> Get(uint32_t key) {
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            return SharedPtr<Value>();
+        }
+        order_.splice(order_.begin(), order_, it->second);
+        return it->second->second;
+    }
+
+    void Put(uint32_t key, SharedPtr<Value> value) {
+        order_.emplace_front(key, std::move(value));
+        index_[key] = order_.begin();
+        if (order_.size() * kValueSize > kCapacity) {
+            index_.erase(order_.back().first);
+            order_.pop_back();
+        }
+    }
+
+private:
+    std::list<std::pair<uint32_t, SharedPtr<Value>>> order_;
+    std::unordered_map<uint32_t, decltype(order_)::iterator> index_;
+};
+
+template <typename Cache>
+void Run(const char* name, const std::vector<uint32_t>& trace, Cache& cache) {
+    std::vector<SharedPtr<Value>> held(kHeld);
+    size_t loads = 0;
+    RunBenchmark(name, trace.size(), [&] {
+        for (size_t i = 0; i < trace.size(); ++i) {
+            SharedPtr<Value> value = cache.Get(trace[i]);
+            if (!value) {
+                ++loads;
+                value = MakeShared<Value>();
+                cache.Put(trace[i], value);
+            }
+            held[i % kHeld] = std::move(value);
+        }
+    });
+    std::cout << "  hit rate: " << 100.0 * (trace.size() - loads) / trace.size() << "%"
+              << std::endl;
+}
+
+int main() {
+    std::vector<uint32_t> trace = ZipfTrace();
+
+    StrictLru lru;
+    Run("strict LRU", trace, lru);
+
+    for (size_t shards : {1, 16}) {
+        SharedLruCache<uint32_t, Value> cache(kCapacity, shards);
+        Run(shards == 1 ? "SharedLruCache, 1 shard" : "SharedLruCache, 16 shards", trace, cache);
+        auto stats = cache.GetStats();
+        std::cout << "  resurrections: " << stats.resurrections << ", evictions: "
+                  << stats.evictions << std::endl;
+    }
+}
@@ -0,0 +1,96 @@
+#include "../src/shared/map_shared.h"
+#include "./bench.h"
+#include <random>
+#include <vector>
+
+// Random 4 KiB record reads from a data file: `MapShared` slices vs. `pread` into heap buffers.
+// "cold" evicts the file from the page cache first (POSIX_FADV_DONTNEED), "warm" runs again.
+
+constexpr size_t kFileSize = 256 << 20;
+constexpr size_t kRecordSize = 4096;
+constexpr size_t kReads = 200'000;
+
+std::string CreateFile() {
+    char path[] = "/tmp/bench_map_shared_XXXXXX";
+    int fd = mkstemp(path);
+    std::vector<char> chunk(1 << 20);
+    for (size_t i = 0; i < chunk.size(); ++i) {
+        chunk[i] = static_cast<char>(i * 31);
+    }
+    for (size_t written = 0; written < kFileSize; written += chunk.size()) {
+        if (write(fd, chunk.data(), chunk.size()) < 0) {
+            break;
+        }
+    }
+    fsync(fd);
+    close(fd);
+    return path;
+}
+
+void EvictFromPageCache(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+std::vector<size_t> RandomOffsets() {
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<size_t> dist(0, kFileSize / kRecordSize - 1);
+    std::vector<size_t> offsets(kReads);
+    for (size_t& offset : offsets) {
+        offset = dist(rng) * kRecordSize;
+    }
+    return offsets;
+}
+
+int main() {
+    std::string path = CreateFile();
+    std::vector<size_t> offsets = RandomOffsets();
+
+    auto run_pread = [&](const std::string& name) {
+        int fd = open(path.c_str(), O_RDONLY);
+        size_t sum = 0;
+        RunBenchmark(name, kReads, [&] {
+            for (size_t offset : offsets) {
+                std::vector<std::byte> record(kRecordSize);
+                if (pread(fd, record.data(), kRecordSize, offset) > 0) {
+                    sum += static_cast<size_t>(record[kRecordSize / 2]);
+                }
+            }
+        });
+        DoNotOptimize(sum);
+        close(fd);
+    };
+
+    auto run_mapped = [&](const std::string& name, SharedBytes& file) {
+        size_t sum = 0;
+        RunBenchmark(name, kReads, [&] {
+            for (size_t offset : offsets) {
+                SharedBytes record = file.Subspan(offset, kRecordSize);
+                sum += static_cast<size_t>(record[kRecordSize / 2]);
+            }
+        });
+        DoNotOptimize(sum);
+    };
+
+    EvictFromPageCache(path);
+    run_pread("pread, cold");
+    run_pread("pread, warm");
+
+    EvictFromPageCache(path);
+    {
+        SharedBytes file = MapShared(path, {.advice = MapAdvice::kRandom});
+        run_mapped("MapShared, cold", file);
+        run_mapped("MapShared, warm", file);
+    }
+
+    EvictFromPageCache(path);
+    {
+        SharedBytes file;
+        RunBenchmark("MapShared + MAP_POPULATE, open", 1,
+                     [&] { file = MapShared(path, {.populate = true}); });
+        run_mapped("MapShared + MAP_POPULATE, reads", file);
+    }
+
+    std::remove(path.c_str());
+}
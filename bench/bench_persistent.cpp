@@ -0,0 +1,100 @@
+#include "../src/persistent/persistent_map.h"
+#include "../src/persistent/persistent_vector.h"
+#include "./bench.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Edit-heavy workload on a 100k-element container with a snapshot taken every `kSnapshotEvery`
+// edits and the last `kKeptSnapshots` of them kept alive (an undo history): copying a standard
+// container for each snapshot vs. persistent containers that share everything but the edited
+// paths.
+
+constexpr size_t kSize = 100'000;
+constexpr size_t kEdits = 200'000;
+constexpr size_t kSnapshotEvery = 100;
+constexpr size_t kKeptSnapshots = 64;
+
+template <typename Container>
+void TakeSnapshot(std::vector<Container>& history, size_t i, const Container& current) {
+    if (i % kSnapshotEvery == 0) {
+        history[i / kSnapshotEvery % kKeptSnapshots] = current;
+    }
+}
+
+// Spreads consecutive edits over the whole container
+size_t Position(size_t i) {
+    return (i * 7919) % kSize;
+}
+
+int main() {
+    {
+        std::vector<uint64_t> base(kSize);
+        PersistentVector<uint64_t> persistent_base;
+        for (size_t i = 0; i < kSize; ++i) {
+            persistent_base.PushBack(0);
+        }
+
+        std::vector<std::vector<uint64_t>> history(kKeptSnapshots);
+        RunBenchmark("std::vector, copy per snapshot", kEdits, [&] {
+            std::vector<uint64_t> current = base;
+            for (size_t i = 0; i < kEdits; ++i) {
+                current[Position(i)] += i;
+                TakeSnapshot(history, i, current);
+            }
+            DoNotOptimize(current[0]);
+        });
+        history.assign(kKeptSnapshots, {});
+
+        std::vector<PersistentVector<uint64_t>> persistent_history(kKeptSnapshots);
+        RunBenchmark("PersistentVector", kEdits, [&] {
+            PersistentVector<uint64_t> current = persistent_base;
+            for (size_t i = 0; i < kEdits; ++i) {
+                size_t position = Position(i);
+                current.Set(position, current[position] + i);
+                TakeSnapshot(persistent_history, i, current);
+            }
+            DoNotOptimize(current[0]);
+        });
+
+        RunBenchmark("PersistentVector, no snapshots", kEdits, [&] {
+            PersistentVector<uint64_t> current = persistent_base;
+            for (size_t i = 0; i < kEdits; ++i) {
+                size_t position = Position(i);
+                current.Set(position, current[position] + i);
+            }
+            DoNotOptimize(current[0]);
+        });
+    }
+
+    {
+        std::unordered_map<uint64_t, uint64_t> base;
+        PersistentMap<uint64_t, uint64_t> persistent_base;
+        for (size_t i = 0; i < kSize; ++i) {
+            base[i] = 0;
+            persistent_base.Set(i, 0);
+        }
+
+        std::vector<std::unordered_map<uint64_t, uint64_t>> history(kKeptSnapshots);
+        RunBenchmark("std::unordered_map, copy per snapshot", kEdits, [&] {
+            std::unordered_map<uint64_t, uint64_t> current = base;
+            for (size_t i = 0; i < kEdits; ++i) {
+                current[Position(i)] += i;
+                TakeSnapshot(history, i, current);
+            }
+            DoNotOptimize(current[0]);
+        });
+        history.assign(kKeptSnapshots, {});
+
+        std::vector<PersistentMap<uint64_t, uint64_t>> persistent_history(kKeptSnapshots);
+        RunBenchmark("PersistentMap", kEdits, [&] {
+            PersistentMap<uint64_t, uint64_t> current = persistent_base;
+            for (size_t i = 0; i < kEdits; ++i) {
+                size_t position = Position(i);
+                current.Set(position, *current.Find(position) + i);
+                TakeSnapshot(persistent_history, i, current);
+            }
+            DoNotOptimize(*current.Find(0));
+        });
+    }
+}
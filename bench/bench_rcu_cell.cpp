@@ -0,0 +1,90 @@
+#include "../src/shared/rcu_cell.h"
+#include "./bench.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Read scaling of `RcuCell::Read` vs. copying a `SharedPtr` under a mutex, with a writer
+// publishing a new config every 10 ms, and the latency of `RcuCell::Publish`.
+
+struct Config {
+    uint64_t limits[16] = {};
+};
+
+constexpr auto kDuration = std::chrono::milliseconds(300);
+constexpr auto kWriteInterval = std::chrono::milliseconds(10);
+
+template <typename Read, typename Write>
+void RunReaders(const std::string& name, size_t threads, Read read, Write write) {
+    std::atomic<bool> stop = false;
+    std::atomic<uint64_t> total = 0;
+    std::vector<std::thread> readers;
+    for (size_t i = 0; i < threads; ++i) {
+        readers.emplace_back([&] {
+            uint64_t reads = 0;
+            uint64_t sum = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                sum += read();
+                ++reads;
+            }
+            DoNotOptimize(sum);
+            total += reads;
+        });
+    }
+
+    std::vector<double> latencies;
+    auto deadline = std::chrono::steady_clock::now() + kDuration;
+    while (std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(kWriteInterval);
+        auto start = std::chrono::steady_clock::now();
+        write();
+        latencies.push_back(
+            std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start)
+                .count());
+    }
+    stop = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    double seconds = std::chrono::duration<double>(kDuration).count();
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << name << ", " << threads << " readers: " << total / seconds / 1e6
+              << " Mreads/s, write latency median " << latencies[latencies.size() / 2]
+              << " us, max " << latencies.back() << " us" << std::endl;
+}
+
+int main() {
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+    for (size_t threads : {1, 2, 4}) {
+        RcuCell<Config> cell(MakeShared<Config>());
+        RunReaders(
+            "RcuCell", threads, [&] { return cell.Read()->limits[3]; },
+            [&] { cell.Emplace(); });
+
+        std::mutex mutex;
+        SharedPtr<const Config> current = MakeShared<Config>();
+        RunReaders(
+            "mutex + SharedPtr copy", threads,
+            [&] {
+                SharedPtr<const Config> config;
+                {
+                    std::lock_guard lock(mutex);
+                    config = current;
+                }
+                uint64_t value = config->limits[3];
+                std::lock_guard lock(mutex);
+                config.Reset();
+                return value;
+            },
+            [&] {
+                SharedPtr<const Config> next = MakeShared<Config>();
+                std::lock_guard lock(mutex);
+                current = next;
+                next.Reset();
+            });
+    }
+}
@@ -0,0 +1,89 @@
+#include "../src/persistent/rope.h"
+#include "./bench.h"
+#include <random>
+#include <string>
+#include <vector>
+
+// Editor-like trace on a 8 MiB buffer: typing bursts and deletions at random cursor positions,
+// plus a cut-and-paste of a 64 KiB block every `kPasteEvery` edits.
+// `std::string` moves the tail on every edit, `Rope` splits and joins O(log n) nodes.
+
+constexpr size_t kTextSize = 8 << 20;
+constexpr size_t kEdits = 20'000;
+constexpr size_t kPasteEvery = 100;
+constexpr size_t kBlock = 64 << 10;
+
+struct Edit {
+    size_t pos;
+    size_t erase;
+    std::string insert;
+    bool paste;
+};
+
+int main() {
+    std::mt19937_64 gen(42);
+    std::string text(kTextSize, ' ');
+    for (char& c : text) {
+        c = 'a' + gen() % 26;
+    }
+
+    std::vector<Edit> trace;
+    size_t size = kTextSize;
+    for (size_t i = 0; i < kEdits; ++i) {
+        Edit edit{gen() % (size - kBlock), 0, {}, i % kPasteEvery == 0};
+        if (!edit.paste) {
+            if (gen() % 3 == 0) {
+                edit.erase = gen() % 8 + 1;
+            } else {
+                edit.insert.assign(gen() % 8 + 1, 'x');
+            }
+        }
+        size = size - edit.erase + edit.insert.size();
+        trace.push_back(std::move(edit));
+    }
+
+    RunBenchmark("std::string", kEdits, [&] {
+        std::string buffer = text;
+        for (const Edit& edit : trace) {
+            if (edit.paste) {
+                std::string block = buffer.substr(edit.pos, kBlock);
+                buffer.erase(edit.pos, kBlock);
+                buffer.insert(buffer.size() / 2, block);
+            } else {
+                buffer.erase(edit.pos, edit.erase);
+                buffer.insert(edit.pos, edit.insert);
+            }
+        }
+        DoNotOptimize(buffer[0]);
+    });
+
+    Rope result;
+    RunBenchmark("Rope", kEdits, [&] {
+        Rope buffer(text);
+        for (const Edit& edit : trace) {
+            if (edit.paste) {
+                Rope block = buffer.Substr(edit.pos, kBlock);
+                buffer.Erase(edit.pos, kBlock);
+                buffer.Insert(buffer.Size() / 2, block);
+            } else {
+                buffer.Erase(edit.pos, edit.erase);
+                buffer.Insert(edit.pos, edit.insert);
+            }
+        }
+        result = buffer;
+    });
+    std::cout << "  rope height: " << result.Height() << std::endl;
+
+    size_t chunks = 0;
+    RunBenchmark("Rope chunk scan", kTextSize, [&] {
+        size_t typed = 0;
+        result.ForEachChunk([&](std::string_view chunk) {
+            ++chunks;
+            for (char c : chunk) {
+                typed += c == 'x';
+            }
+        });
+        DoNotOptimize(typed);
+    });
+    std::cout << "  chunks: " << chunks << std::endl;
+}
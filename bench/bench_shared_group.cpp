@@ -0,0 +1,93 @@
+#include "../src/shared/shared_group.h"
+#include "./bench.h"
+#include <cstdlib>
+#include <new>
+#include <tuple>
+#include <vector>
+
+// Request + parser + buffer created per request: three `MakeShared` calls vs. one
+// `MakeSharedGroup`, and `MakeSharedBatch` vs. a loop of `MakeShared`.
+// Reports the number of heap allocations and the time to create and to traverse the objects.
+
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    ++allocations;
+    if (void* ptr = std::malloc(size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+struct Request {
+    uint64_t id = 0;
+    uint64_t length = 0;
+};
+
+struct Parser {
+    uint64_t state = 0;
+};
+
+struct Buffer {
+    char data[64] = {};
+};
+
+using Group = std::tuple<SharedPtr<Request>, SharedPtr<Parser>, SharedPtr<Buffer>>;
+
+constexpr size_t kGroups = 1'000'000;
+
+template <typename MakeGroup>
+void RunGroups(const std::string& name, MakeGroup make_group) {
+    std::vector<Group> groups;
+    groups.reserve(kGroups);
+
+    size_t before = allocations;
+    RunBenchmark(name + ", create", kGroups, [&] {
+        for (size_t i = 0; i < kGroups; ++i) {
+            groups.push_back(make_group());
+        }
+    });
+    std::cout << "  allocations per group: " << double(allocations - before) / kGroups
+              << std::endl;
+
+    uint64_t sum = 0;
+    RunBenchmark(name + ", traverse", kGroups, [&] {
+        for (auto& [request, parser, buffer] : groups) {
+            sum += request->id + parser->state + buffer->data[0];
+        }
+    });
+    DoNotOptimize(sum);
+
+    RunBenchmark(name + ", destroy", kGroups, [&] { groups.clear(); });
+}
+
+int main() {
+    RunGroups("3 x MakeShared", [] {
+        return Group{MakeShared<Request>(), MakeShared<Parser>(), MakeShared<Buffer>()};
+    });
+    RunGroups("MakeSharedGroup", [] { return MakeSharedGroup<Request, Parser, Buffer>(); });
+
+    std::vector<SharedPtr<Buffer>> buffers;
+    size_t before = allocations;
+    RunBenchmark("loop of MakeShared<Buffer>", kGroups, [&] {
+        buffers.reserve(kGroups);
+        for (size_t i = 0; i < kGroups; ++i) {
+            buffers.push_back(MakeShared<Buffer>());
+        }
+    });
+    std::cout << "  allocations: " << allocations - before << std::endl;
+    buffers = {};
+
+    before = allocations;
+    RunBenchmark("MakeSharedBatch<Buffer>", kGroups,
+                 [&] { buffers = MakeSharedBatch<Buffer>(kGroups); });
+    std::cout << "  allocations: " << allocations - before << std::endl;
+}
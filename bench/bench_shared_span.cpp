@@ -0,0 +1,67 @@
+#include "../src/shared/shared_span.h"
+#include "./bench.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Parse a received buffer of length-prefixed messages and hand every message to several
+// subscribers: copying each message into a `std::string` vs. zero-copy `SharedBytes` slices.
+
+constexpr size_t kMessages = 200'000;
+constexpr size_t kSubscribers = 4;
+constexpr size_t kRounds = 5;
+
+SharedBytes BuildBuffer() {
+    std::vector<std::byte> raw;
+    for (size_t i = 0; i < kMessages; ++i) {
+        uint32_t size = 64 + i % 512;
+        auto header = std::as_bytes(std::span(&size, 1));
+        raw.insert(raw.end(), header.begin(), header.end());
+        raw.insert(raw.end(), size, std::byte(i));
+    }
+    return MakeSharedBytes(raw);
+}
+
+uint32_t ReadSize(const std::byte* data) {
+    uint32_t size;
+    std::memcpy(&size, data, sizeof(size));
+    return size;
+}
+
+int main() {
+    SharedBytes buffer = BuildBuffer();
+
+    RunBenchmark("copy into std::string", kMessages * kRounds, [&] {
+        for (size_t round = 0; round < kRounds; ++round) {
+            std::vector<std::vector<std::string>> subscribers(kSubscribers);
+            for (size_t offset = 0; offset < buffer.Size();) {
+                uint32_t size = ReadSize(buffer.Data() + offset);
+                offset += sizeof(size);
+                std::string message(reinterpret_cast<const char*>(buffer.Data() + offset), size);
+                for (size_t i = 0; i + 1 < kSubscribers; ++i) {
+                    subscribers[i].push_back(message);
+                }
+                subscribers.back().push_back(std::move(message));
+                offset += size;
+            }
+            DoNotOptimize(subscribers);
+        }
+    });
+
+    RunBenchmark("SharedBytes slices", kMessages * kRounds, [&] {
+        for (size_t round = 0; round < kRounds; ++round) {
+            std::vector<std::vector<SharedBytes>> subscribers(kSubscribers);
+            for (size_t offset = 0; offset < buffer.Size();) {
+                uint32_t size = ReadSize(buffer.Data() + offset);
+                offset += sizeof(size);
+                SharedBytes message = buffer.Subspan(offset, size);
+                for (size_t i = 0; i + 1 < kSubscribers; ++i) {
+                    subscribers[i].push_back(message);
+                }
+                subscribers.back().push_back(std::move(message));
+                offset += size;
+            }
+            DoNotOptimize(subscribers);
+        }
+    });
+}
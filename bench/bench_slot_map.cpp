@@ -0,0 +1,95 @@
+#include "../src/slot_map/slot_map.h"
+#include "../src/weak/weak.h"
+#include "./bench.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+// Objects observed through "is it still alive" handles:
+// `vector<SharedPtr<T>>` + `WeakPtr<T>` observers vs. `SlotMap<T>` + `SlotHandle<T>`.
+// A tenth of the objects is erased, then the survivors are iterated and all handles are looked up
+// in random order.
+
+struct Particle {
+    float x = 0;
+    float y = 0;
+    float vx = 1;
+    float vy = 1;
+};
+
+constexpr size_t kObjects = 1'000'000;
+
+int main() {
+    std::mt19937 gen(42);
+    std::vector<size_t> order(kObjects);
+    for (size_t i = 0; i < kObjects; ++i) {
+        order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), gen);
+
+    std::cout << "observer size: WeakPtr " << sizeof(WeakPtr<Particle>) << " bytes, SlotHandle "
+              << sizeof(SlotHandle<Particle>) << " bytes" << std::endl;
+
+    {
+        std::vector<SharedPtr<Particle>> owners;
+        std::vector<WeakPtr<Particle>> observers;
+        RunBenchmark("SharedPtr: create", kObjects, [&] {
+            for (size_t i = 0; i < kObjects; ++i) {
+                owners.push_back(MakeShared<Particle>());
+                observers.emplace_back(owners.back());
+            }
+        });
+        for (size_t i = 0; i < kObjects; i += 10) {
+            owners[i].Reset();
+        }
+        float sum = 0;
+        RunBenchmark("SharedPtr: iterate", kObjects, [&] {
+            for (auto& owner : owners) {
+                if (owner) {
+                    sum += owner->x + owner->vx;
+                }
+            }
+        });
+        size_t alive = 0;
+        RunBenchmark("WeakPtr: lookup", kObjects, [&] {
+            for (size_t i : order) {
+                if (SharedPtr<Particle> particle = observers[i].Lock()) {
+                    sum += particle->y;
+                    ++alive;
+                }
+            }
+        });
+        DoNotOptimize(sum);
+        DoNotOptimize(alive);
+    }
+
+    {
+        SlotMap<Particle> particles;
+        std::vector<SlotHandle<Particle>> handles;
+        RunBenchmark("SlotMap: create", kObjects, [&] {
+            for (size_t i = 0; i < kObjects; ++i) {
+                handles.push_back(particles.Emplace());
+            }
+        });
+        for (size_t i = 0; i < kObjects; i += 10) {
+            particles.Erase(handles[i]);
+        }
+        float sum = 0;
+        RunBenchmark("SlotMap: iterate", kObjects, [&] {
+            for (const Particle& particle : particles) {
+                sum += particle.x + particle.vx;
+            }
+        });
+        size_t alive = 0;
+        RunBenchmark("SlotHandle: lookup", kObjects, [&] {
+            for (size_t i : order) {
+                if (Particle* particle = particles.Get(handles[i])) {
+                    sum += particle->y;
+                    ++alive;
+                }
+            }
+        });
+        DoNotOptimize(sum);
+        DoNotOptimize(alive);
+    }
+}
@@ -0,0 +1,83 @@
+#include "../src/intrusive/intrusive.h"
+#include "../src/teardown/teardown.h"
+#include "./bench.h"
+#include <vector>
+
+// Destruction of a 10M-node list and a 10M-node binary tree.
+// Recursive destructors overflow the stack on the list, so they are measured on the tree only;
+// the parallel mode tears down the subtrees below the top levels on all hardware threads.
+
+constexpr size_t kNodes = 10'000'000;
+
+template <typename D>
+struct ListNode : SimpleRefCounted<ListNode<D>, D> {
+    IntrusivePtr<ListNode> next;
+    uint64_t value = 0;
+};
+
+template <typename D>
+struct TreeNode : SimpleRefCounted<TreeNode<D>, D> {
+    IntrusivePtr<TreeNode> left;
+    IntrusivePtr<TreeNode> right;
+    uint64_t value = 0;
+};
+
+// Complete binary tree of `size` nodes in heap order, rooted at `index`
+template <typename D>
+IntrusivePtr<TreeNode<D>> MakeTree(size_t index, size_t size) {
+    if (index >= size) {
+        return nullptr;
+    }
+    IntrusivePtr<TreeNode<D>> node = MakeIntrusive<TreeNode<D>>();
+    node->value = index;
+    node->left = MakeTree<D>(2 * index + 1, size);
+    node->right = MakeTree<D>(2 * index + 2, size);
+    return node;
+}
+
+// Detaches the subtrees `levels` below `root`
+template <typename D>
+std::vector<IntrusivePtr<TreeNode<D>>> Split(IntrusivePtr<TreeNode<D>> root, size_t levels) {
+    std::vector<IntrusivePtr<TreeNode<D>>> frontier;
+    frontier.push_back(std::move(root));
+    for (size_t level = 0; level < levels; ++level) {
+        std::vector<IntrusivePtr<TreeNode<D>>> next;
+        for (auto& node : frontier) {
+            next.push_back(std::move(node->left));
+            next.push_back(std::move(node->right));
+        }
+        frontier = std::move(next);
+    }
+    return frontier;
+}
+
+int main() {
+    {
+        IntrusivePtr<ListNode<IterativeDelete>> head = MakeIntrusive<ListNode<IterativeDelete>>();
+        ListNode<IterativeDelete>* tail = head.Get();
+        for (size_t i = 1; i < kNodes; ++i) {
+            tail->next = MakeIntrusive<ListNode<IterativeDelete>>();
+            tail = tail->next.Get();
+        }
+        RunBenchmark("list, iterative", kNodes, [&] { head.Reset(); });
+    }
+
+    {
+        auto root = MakeTree<DefaultDelete>(0, kNodes);
+        RunBenchmark("tree, recursive", kNodes, [&] { root.Reset(); });
+    }
+
+    {
+        auto root = MakeTree<IterativeDelete>(0, kNodes);
+        RunBenchmark("tree, iterative", kNodes, [&] { root.Reset(); });
+    }
+
+    {
+        // The nodes above the split stay alive until the end of the scope, they are a handful
+        auto root = MakeTree<IterativeDelete>(0, kNodes);
+        auto subtrees = Split(root, 6);
+        std::cout << "hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+        RunBenchmark("tree, parallel", kNodes,
+                     [&] { DestroyInParallel(std::move(subtrees)); });
+    }
+}
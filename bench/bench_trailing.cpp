@@ -0,0 +1,116 @@
+#include "../src/trailing/shared_string.h"
+#include "./bench.h"
+#include <algorithm>  // std::max
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+// Footprint and construction cost of an immutable shared string:
+// `SharedString` (one allocation) vs. `MakeShared<std::string>` (block + heap characters)
+// vs. `SharedPtr<std::string>(new std::string)` (three allocations).
+
+static size_t allocations = 0;
+static size_t allocated_bytes = 0;
+
+// Every replaced `operator new` gets its memory from `std::aligned_alloc` and every replaced
+// `operator delete` returns it with `std::free`. Both stay out of line: inlined into a caller,
+// the `free` looks to GCC like the release of a built-in `operator new` pointer and trips
+// -Wmismatched-new-delete.
+[[gnu::noinline]] void* CountedAllocate(size_t size, size_t alignment) {
+    ++allocations;
+    allocated_bytes += size;
+    // `aligned_alloc` wants a multiple of the alignment
+    size_t rounded = (std::max<size_t>(size, 1) + alignment - 1) / alignment * alignment;
+    if (void* ptr = std::aligned_alloc(alignment, rounded)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void CountedFree(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void* operator new(size_t size) {
+    return CountedAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](size_t size) {
+    return CountedAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    return CountedAllocate(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return CountedAllocate(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* ptr) noexcept {
+    CountedFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    CountedFree(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    CountedFree(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    CountedFree(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    CountedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    CountedFree(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+    CountedFree(ptr);
+}
+
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept {
+    CountedFree(ptr);
+}
+
+constexpr size_t kStrings = 1'000'000;
+
+template <typename String, typename MakeString>
+void RunStrings(const std::string& name, size_t length, MakeString make_string) {
+    std::string source(length, 'a');
+    std::vector<String> strings;
+    strings.reserve(kStrings);
+
+    size_t before = allocations;
+    size_t before_bytes = allocated_bytes;
+    RunBenchmark(name + ", length " + std::to_string(length), kStrings, [&] {
+        for (size_t i = 0; i < kStrings; ++i) {
+            strings.push_back(make_string(source));
+        }
+    });
+    std::cout << "  allocations per string: " << double(allocations - before) / kStrings
+              << ", heap bytes per string: " << double(allocated_bytes - before_bytes) / kStrings
+              << std::endl;
+    DoNotOptimize(strings.data());
+}
+
+int main() {
+    for (size_t length : {8, 40, 200}) {
+        RunStrings<SharedString>("SharedString", length,
+                                 [](const std::string& s) { return SharedString(s); });
+        RunStrings<SharedPtr<std::string>>(
+            "MakeShared<std::string>", length,
+            [](const std::string& s) { return MakeShared<std::string>(s); });
+        RunStrings<SharedPtr<std::string>>("SharedPtr(new std::string)", length,
+                                           [](const std::string& s) {
+                                               return SharedPtr<std::string>(new std::string(s));
+                                           });
+    }
+}
@@ -0,0 +1,61 @@
+#include "../src/unique/unique_array.h"
+#include "./bench.h"
+#include <vector>
+
+// Fill and reduce kernels over aligned `UniqueArray` storage vs. a buffer shifted off
+// the vector-width boundary. Build with -O3 -march=native to let the loops vectorize.
+
+constexpr size_t kSize = 1 << 14;  // fits in L1/L2, so alignment dominates over bandwidth
+constexpr size_t kRounds = 50'000;
+constexpr size_t kLanes = 16;
+
+template <typename Ptr>
+void Fill(Ptr data, size_t size, float value) {
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = value * i;
+    }
+}
+
+// Independent accumulators let the compiler vectorize without reassociating floats.
+template <typename Ptr>
+float Reduce(Ptr data, size_t size) {
+    float acc[kLanes] = {};
+    for (size_t i = 0; i + kLanes <= size; i += kLanes) {
+        for (size_t j = 0; j < kLanes; ++j) {
+            acc[j] += data[i + j];
+        }
+    }
+    float sum = 0;
+    for (float x : acc) {
+        sum += x;
+    }
+    return sum;
+}
+
+template <typename GetData>
+void RunKernels(const std::string& name, GetData get_data) {
+    float sum = 0;
+    RunBenchmark(name + ", fill", kSize * kRounds, [&] {
+        for (size_t r = 0; r < kRounds; ++r) {
+            Fill(get_data(), kSize, static_cast<float>(r));
+            DoNotOptimize(get_data()[r % kSize]);
+        }
+    });
+    RunBenchmark(name + ", reduce", kSize * kRounds, [&] {
+        for (size_t r = 0; r < kRounds; ++r) {
+            sum += Reduce(get_data(), kSize);
+            DoNotOptimize(sum);
+        }
+    });
+    DoNotOptimize(sum);
+}
+
+int main() {
+    auto aligned = UniqueArray<float>::Uninitialized(kSize);
+    RunKernels("UniqueArray<float, 64>", [&aligned] { return aligned.Data(); });
+
+    std::vector<float> storage(kSize + 1);
+    float* misaligned = storage.data() + 1;
+    DoNotOptimize(misaligned);
+    RunKernels("misaligned float*", [misaligned] { return misaligned; });
+}
@@ -0,0 +1,77 @@
+#include "../src/weak/owner.h"
+#include "../src/weak/weak_key_map.h"
+#include "./bench.h"
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+// Side table attaching a value to 1M live objects while they churn: every step creates an
+// object, sets its entry, lets the oldest object die and looks up a random live one.
+// `std::unordered_map` keyed by `WeakPtr` has to be swept for expired keys, here whenever it
+// reaches three times the live count, about where a `WeakKeyMap` of that size sweeps itself.
+// The run without an index is the cost of creating and dropping the objects alone.
+
+constexpr size_t kLive = 1'000'000;
+constexpr size_t kSteps = 10'000'000;
+
+template <typename Set, typename Find>
+void Churn(Set&& set, Find&& find) {
+    std::vector<SharedPtr<uint64_t>> ring(kLive);
+    std::mt19937_64 random(1);
+    uint64_t sum = 0;
+    for (size_t step = 0; step < kSteps; ++step) {
+        SharedPtr<uint64_t>& slot = ring[step % kLive];
+        slot = MakeShared<uint64_t>(step);
+        set(slot, step);
+        const SharedPtr<uint64_t>& key = ring[random() % kLive];
+        if (key) {
+            sum += find(key);
+        }
+    }
+    DoNotOptimize(sum);
+}
+
+int main() {
+    RunBenchmark("no index", kSteps, [&] {
+        Churn([](const SharedPtr<uint64_t>&, uint64_t) {},
+              [](const SharedPtr<uint64_t>& key) {
+                  return *key;
+              });
+    });
+
+    {
+        std::unordered_map<WeakPtr<uint64_t>, uint64_t, OwnerHash, OwnerEqual> map;
+        size_t sweeps = 0;
+        RunBenchmark("unordered_map + sweep", kSteps, [&] {
+            Churn(
+                [&](const SharedPtr<uint64_t>& key, uint64_t value) {
+                    map.emplace(WeakPtr<uint64_t>(key), value);
+                    if (map.size() >= 3 * kLive) {
+                        std::erase_if(map, [](const auto& item) {
+                            return item.first.Expired();
+                        });
+                        ++sweeps;
+                    }
+                },
+                [&](const SharedPtr<uint64_t>& key) {
+                    return map.find(key)->second;
+                });
+        });
+        std::cout << "  sweeps: " << sweeps << ", entries: " << map.size() << std::endl;
+    }
+
+    {
+        WeakKeyMap<uint64_t, uint64_t> map;
+        RunBenchmark("WeakKeyMap", kSteps, [&] {
+            Churn(
+                [&](const SharedPtr<uint64_t>& key, uint64_t value) {
+                    map.Set(key, value);
+                },
+                [&](const SharedPtr<uint64_t>& key) {
+                    return *map.Find(key);
+                });
+        });
+        std::cout << "  entries: " << map.EntryCount() << std::endl;
+    }
+}
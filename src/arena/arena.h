@@ -0,0 +1,222 @@
+#pragma once
+
+#include "../intrusive/intrusive.h"
+#include "../shared/shared.h"
+#include "../unique/unique.h"
+#include <algorithm>  // std::max
+#include <cassert>
+#include <cstddef>  // size_t, std::max_align_t
+#include <cstdint>  // uintptr_t
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Bump allocator that frees all of its memory at once.
+// Objects created by `MakeSharedIn`, `MakeIntrusiveIn` and `MakeUniqueIn` are still destroyed
+// when their last owner dies, but releasing their memory is a no-op: the chunks go back to the
+// heap only in `~Arena`. In debug builds `~Arena` asserts that no such object is still alive.
+class Arena {
+private:
+    struct Chunk {
+        Chunk* next;
+        size_t size;
+    };
+
+public:
+    static constexpr size_t kDefaultChunkSize = 4 << 10;
+    static constexpr size_t kMaxChunkSize = 1 << 20;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    explicit Arena(size_t chunk_size = kDefaultChunkSize) : next_chunk_size_{chunk_size} {
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Destructor
+
+    ~Arena() {
+        assert(live_ == 0 && "an object allocated in the arena outlives it");
+        while (chunks_ != nullptr) {
+            ::operator delete(std::exchange(chunks_, chunks_->next));
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Allocation
+
+    void* Allocate(size_t size, size_t align) {
+        auto aligned = (reinterpret_cast<uintptr_t>(cur_) + align - 1) & ~(align - 1);
+        if (cur_ == nullptr || aligned + size > reinterpret_cast<uintptr_t>(end_)) {
+            NewChunk(size + align);
+            aligned = (reinterpret_cast<uintptr_t>(cur_) + align - 1) & ~(align - 1);
+        }
+        cur_ = reinterpret_cast<char*>(aligned + size);
+        ++live_;
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    template <typename T>
+    void* Allocate() {
+        return Allocate(sizeof(T), alignof(T));
+    }
+
+    // Marks an allocation as dead, the memory itself is reclaimed by `~Arena`
+    void Release() {
+        assert(live_ > 0);
+        --live_;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    // Number of allocations that were not released yet
+    size_t LiveCount() const {
+        return live_;
+    }
+
+    // Bytes taken from the heap
+    size_t Capacity() const {
+        return capacity_;
+    }
+
+private:
+    void NewChunk(size_t min_size) {
+        size_t size = std::max(next_chunk_size_, min_size + sizeof(Chunk));
+        next_chunk_size_ = std::min(next_chunk_size_ * 2, kMaxChunkSize);
+
+        auto* chunk = static_cast<Chunk*>(::operator new(size));
+        chunk->next = chunks_;
+        chunk->size = size;
+        chunks_ = chunk;
+        capacity_ += size;
+
+        cur_ = reinterpret_cast<char*>(chunk + 1);
+        end_ = reinterpret_cast<char*>(chunk) + size;
+    }
+
+    Chunk* chunks_ = nullptr;
+    char* cur_ = nullptr;
+    char* end_ = nullptr;
+    size_t next_chunk_size_;
+    size_t capacity_ = 0;
+    size_t live_ = 0;
+};
+
+// Control Block for MakeSharedIn(Arena&, Args&&...)
+// The object is destroyed as usual, the block is left in the arena.
+template <typename T>
+class ArenaBlock : public IBlock {
+private:
+    void Deleter() override {
+        ptr_->~T();
+    }
+
+    void Destroy() override {
+        Arena* arena = arena_;
+        this->~ArenaBlock();
+        arena->Release();
+    }
+
+public:
+    Arena* arena_;
+    T* ptr_ = nullptr;
+    alignas(T) char bytes_[sizeof(T)];
+
+    template <typename... Args>
+    explicit ArenaBlock(Arena* arena, Args&&... args) : IBlock(), arena_{arena} {
+        ptr_ = new (bytes_) T(std::forward<Args>(args)...);
+    }
+};
+
+// `MakeShared` that places the control block and the object in `arena`.
+// `EnableSharedFromThis` is not supported for such objects.
+template <typename T, typename... Args>
+SharedPtr<T> MakeSharedIn(Arena& arena, Args&&... args) {
+    void* raw = arena.Allocate<ArenaBlock<T>>();
+    ArenaBlock<T>* block = nullptr;
+    try {
+        block = new (raw) ArenaBlock<T>(&arena, std::forward<Args>(args)...);
+    } catch (...) {
+        arena.Release();
+        throw;
+    }
+    return SharedPtr<T>(static_cast<IBlock*>(block), block->ptr_);
+}
+
+// Deleter policy for `RefCounted` objects created by `MakeIntrusiveIn`.
+// The owning arena is stored right before the object.
+struct ArenaDelete {
+    template <typename T>
+    static void Destroy(T* object) {
+        Arena* arena = *(reinterpret_cast<Arena**>(object) - 1);
+        object->~T();
+        arena->Release();
+    }
+};
+
+// True if `T` derives from `RefCounted<T, Counter, ArenaDelete>`
+template <typename T>
+struct UsesArenaDelete {
+private:
+    template <typename Counter>
+    static std::true_type Check(const RefCounted<T, Counter, ArenaDelete>*);
+    static std::false_type Check(...);
+
+public:
+    static constexpr bool value = decltype(Check(std::declval<T*>()))::value;
+};
+
+// `MakeIntrusive` for objects living in `arena`, `T` must be destroyed with `ArenaDelete`
+template <typename T, typename... Args>
+IntrusivePtr<T> MakeIntrusiveIn(Arena& arena, Args&&... args) {
+    // Any other policy would hand arena memory to the heap
+    static_assert(UsesArenaDelete<T>::value, "T must be RefCounted with ArenaDelete");
+    constexpr size_t kAlign = std::max(alignof(T), alignof(Arena*));
+    constexpr size_t kHeader = (sizeof(Arena*) + kAlign - 1) / kAlign * kAlign;
+    auto* raw = static_cast<char*>(arena.Allocate(kHeader + sizeof(T), kAlign));
+    *reinterpret_cast<Arena**>(raw + kHeader - sizeof(Arena*)) = &arena;
+    try {
+        return IntrusivePtr<T>(new (raw + kHeader) T(std::forward<Args>(args)...));
+    } catch (...) {
+        arena.Release();
+        throw;
+    }
+}
+
+// `UniquePtr` deleter for objects living in an arena
+template <typename T>
+class ArenaDeleter {
+public:
+    ArenaDeleter() = default;
+
+    explicit ArenaDeleter(Arena* arena) : arena_{arena} {
+    }
+
+    void operator()(T* ptr) const {
+        ptr->~T();
+        arena_->Release();
+    }
+
+private:
+    Arena* arena_ = nullptr;
+};
+
+template <typename T>
+using ArenaUniquePtr = UniquePtr<T, ArenaDeleter<T>>;
+
+template <typename T, typename... Args>
+ArenaUniquePtr<T> MakeUniqueIn(Arena& arena, Args&&... args) {
+    void* raw = arena.Allocate<T>();
+    T* ptr = nullptr;
+    try {
+        ptr = new (raw) T(std::forward<Args>(args)...);
+    } catch (...) {
+        arena.Release();
+        throw;
+    }
+    return ArenaUniquePtr<T>(ptr, ArenaDeleter<T>(&arena));
+}
@@ -0,0 +1,355 @@
+#pragma once
+
+#include "../intrusive/intrusive.h"
+#include <cassert>
+#include <cstddef>  // size_t, std::nullptr_t
+#include <cstdint>
+#include <new>        // std::bad_alloc
+#include <stdexcept>  // std::logic_error, std::length_error, std::invalid_argument
+#include <sys/mman.h>
+#include <type_traits>
+#include <utility>
+
+// Contiguous region whose objects are addressed by 32-bit offsets from its base.
+// Offsets count `kScale`-byte units, so a region spans up to 32 GiB. There is one base per
+// process: while a `CompressedArena` is alive it is the one `CompressedIntrusivePtr` and
+// `CompressedUniquePtr` decode against, and creating a second one throws. Pointers that do not
+// fit in an offset are refused in every build, not only by debug asserts. Memory is reclaimed
+// only when the arena dies.
+class CompressedArena {
+public:
+    static constexpr size_t kScale = 8;
+    static constexpr size_t kMaxCapacity = kScale << 32;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    // Reserves `capacity` bytes of address space, pages are committed on first touch
+    explicit CompressedArena(size_t capacity) {
+        if (current_ != nullptr) {
+            throw std::logic_error("only one CompressedArena may be alive");
+        }
+        // Every address handed out must be encodable
+        if (capacity > kMaxCapacity) {
+            throw std::length_error("CompressedArena capacity exceeds kMaxCapacity");
+        }
+        void* raw = mmap(nullptr, capacity, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (raw == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        base_ = static_cast<char*>(raw);
+        // Offset 0 encodes `nullptr`, so the first unit is never handed out
+        cur_ = base_ + kScale;
+        end_ = base_ + capacity;
+        current_ = this;
+    }
+
+    CompressedArena(const CompressedArena&) = delete;
+    CompressedArena& operator=(const CompressedArena&) = delete;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Destructor
+
+    ~CompressedArena() {
+        assert(live_ == 0 && "an object allocated in the arena outlives it");
+        munmap(base_, end_ - base_);
+        current_ = nullptr;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Allocation
+
+    static CompressedArena& Current() {
+        assert(current_ != nullptr);
+        return *current_;
+    }
+
+    void* Allocate(size_t size, size_t align) {
+        if (align < kScale) {
+            align = kScale;
+        }
+        auto aligned = (reinterpret_cast<uintptr_t>(cur_) + align - 1) & ~(align - 1);
+        if (aligned + size > reinterpret_cast<uintptr_t>(end_)) {
+            throw std::bad_alloc();
+        }
+        cur_ = reinterpret_cast<char*>(aligned + size);
+        ++live_;
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    // Marks an allocation as dead, the memory itself is reclaimed by `~CompressedArena`
+    void Release() {
+        assert(live_ > 0);
+        --live_;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    // Throws for a pointer outside of the current arena, which would decode to another object
+    static uint32_t Compress(const void* ptr) {
+        if (ptr == nullptr) {
+            return 0;
+        }
+        auto address = reinterpret_cast<uintptr_t>(ptr);
+        if (current_ == nullptr || address <= reinterpret_cast<uintptr_t>(current_->base_) ||
+            address >= reinterpret_cast<uintptr_t>(current_->end_) || address % kScale != 0) {
+            throw std::invalid_argument("pointer is not in the current CompressedArena");
+        }
+        return (address - reinterpret_cast<uintptr_t>(current_->base_)) / kScale;
+    }
+
+    static void* Decompress(uint32_t offset) {
+        return offset == 0 ? nullptr : current_->base_ + size_t{offset} * kScale;
+    }
+
+    // Number of allocations that were not released yet
+    size_t LiveCount() const {
+        return live_;
+    }
+
+    // Bytes handed out so far
+    size_t Used() const {
+        return cur_ - base_;
+    }
+
+private:
+    static inline CompressedArena* current_ = nullptr;
+
+    char* base_ = nullptr;
+    char* cur_ = nullptr;
+    char* end_ = nullptr;
+    size_t live_ = 0;
+};
+
+// Deleter policy for `RefCounted` objects created by `MakeCompressedIntrusive`
+struct CompressedArenaDelete {
+    template <typename T>
+    static void Destroy(T* object) {
+        object->~T();
+        CompressedArena::Current().Release();
+    }
+};
+
+// `IntrusivePtr` stored in 4 bytes. `T` must live in the current `CompressedArena`.
+template <typename T>
+class CompressedIntrusivePtr {
+private:
+    template <typename Y>
+    friend class CompressedIntrusivePtr;
+
+public:
+    // Constructors
+    CompressedIntrusivePtr() = default;
+
+    CompressedIntrusivePtr(std::nullptr_t) {
+    }
+
+    CompressedIntrusivePtr(T* ptr) : offset_{CompressedArena::Compress(ptr)} {
+        if (ptr != nullptr) {
+            ptr->IncRef();
+        }
+    }
+
+    template <typename Y>
+    CompressedIntrusivePtr(const CompressedIntrusivePtr<Y>& other)
+        : CompressedIntrusivePtr(static_cast<T*>(other.Get())) {
+    }
+
+    template <typename Y>
+    CompressedIntrusivePtr(CompressedIntrusivePtr<Y>&& other)
+        : offset_{CompressedArena::Compress(static_cast<T*>(other.Get()))} {
+        other.offset_ = 0;
+    }
+
+    CompressedIntrusivePtr(const CompressedIntrusivePtr& other) : offset_{other.offset_} {
+        if (T* ptr = Get()) {
+            ptr->IncRef();
+        }
+    }
+
+    CompressedIntrusivePtr(CompressedIntrusivePtr&& other)
+        : offset_{std::exchange(other.offset_, 0)} {
+    }
+
+    // `operator=`-s
+    CompressedIntrusivePtr& operator=(const CompressedIntrusivePtr& other) {
+        if (offset_ != other.offset_) {
+            CompressedIntrusivePtr(other).Swap(*this);
+        }
+        return *this;
+    }
+
+    CompressedIntrusivePtr& operator=(CompressedIntrusivePtr&& other) {
+        if (this != &other) {
+            CompressedIntrusivePtr(std::move(other)).Swap(*this);
+        }
+        return *this;
+    }
+
+    // Destructor
+    ~CompressedIntrusivePtr() {
+        Reset();
+    }
+
+    // Modifiers
+    void Reset() {
+        if (T* ptr = Get()) {
+            offset_ = 0;
+            ptr->DecRef();
+        }
+    }
+
+    void Reset(T* ptr) {
+        CompressedIntrusivePtr(ptr).Swap(*this);
+    }
+
+    void Swap(CompressedIntrusivePtr& other) {
+        std::swap(offset_, other.offset_);
+    }
+
+    // Observers
+    T* Get() const {
+        return static_cast<T*>(CompressedArena::Decompress(offset_));
+    }
+
+    T& operator*() const {
+        return *Get();
+    }
+
+    T* operator->() const {
+        return Get();
+    }
+
+    size_t UseCount() const {
+        T* ptr = Get();
+        return ptr == nullptr ? 0 : ptr->RefCount();
+    }
+
+    explicit operator bool() const {
+        return offset_ != 0;
+    }
+
+private:
+    uint32_t offset_ = 0;
+};
+
+// True if `T` derives from `RefCounted<T, Counter, CompressedArenaDelete>`
+template <typename T>
+struct UsesCompressedArenaDelete {
+private:
+    template <typename Counter>
+    static std::true_type Check(const RefCounted<T, Counter, CompressedArenaDelete>*);
+    static std::false_type Check(...);
+
+public:
+    static constexpr bool value = decltype(Check(std::declval<T*>()))::value;
+};
+
+// `MakeIntrusive` in the current `CompressedArena`, `T` must be destroyed with
+// `CompressedArenaDelete`
+template <typename T, typename... Args>
+CompressedIntrusivePtr<T> MakeCompressedIntrusive(Args&&... args) {
+    static_assert(UsesCompressedArenaDelete<T>::value,
+                  "T must be RefCounted with CompressedArenaDelete");
+    CompressedArena& arena = CompressedArena::Current();
+    void* raw = arena.Allocate(sizeof(T), alignof(T));
+    try {
+        return CompressedIntrusivePtr<T>(new (raw) T(std::forward<Args>(args)...));
+    } catch (...) {
+        arena.Release();
+        throw;
+    }
+}
+
+// `UniquePtr` stored in 4 bytes. The object is destroyed in place, its memory stays in the arena.
+template <typename T>
+class CompressedUniquePtr {
+public:
+    // Constructors
+    CompressedUniquePtr() = default;
+
+    CompressedUniquePtr(std::nullptr_t) {
+    }
+
+    explicit CompressedUniquePtr(T* ptr) : offset_{CompressedArena::Compress(ptr)} {
+    }
+
+    CompressedUniquePtr(const CompressedUniquePtr&) = delete;
+
+    CompressedUniquePtr(CompressedUniquePtr&& other) : offset_{std::exchange(other.offset_, 0)} {
+    }
+
+    // `operator=`-s
+    CompressedUniquePtr& operator=(const CompressedUniquePtr&) = delete;
+
+    CompressedUniquePtr& operator=(CompressedUniquePtr&& other) {
+        if (this != &other) {
+            Reset(other.Release());
+        }
+        return *this;
+    }
+
+    CompressedUniquePtr& operator=(std::nullptr_t) {
+        Reset();
+        return *this;
+    }
+
+    // Destructor
+    ~CompressedUniquePtr() {
+        Reset();
+    }
+
+    // Modifiers
+    T* Release() {
+        T* ptr = Get();
+        offset_ = 0;
+        return ptr;
+    }
+
+    void Reset(T* ptr = nullptr) {
+        T* old = Get();
+        offset_ = CompressedArena::Compress(ptr);
+        if (old != nullptr) {
+            old->~T();
+            CompressedArena::Current().Release();
+        }
+    }
+
+    void Swap(CompressedUniquePtr& other) {
+        std::swap(offset_, other.offset_);
+    }
+
+    // Observers
+    T* Get() const {
+        return static_cast<T*>(CompressedArena::Decompress(offset_));
+    }
+
+    T& operator*() const {
+        return *Get();
+    }
+
+    T* operator->() const {
+        return Get();
+    }
+
+    explicit operator bool() const {
+        return offset_ != 0;
+    }
+
+private:
+    uint32_t offset_ = 0;
+};
+
+template <typename T, typename... Args>
+CompressedUniquePtr<T> MakeCompressedUnique(Args&&... args) {
+    CompressedArena& arena = CompressedArena::Current();
+    void* raw = arena.Allocate(sizeof(T), alignof(T));
+    try {
+        return CompressedUniquePtr<T>(new (raw) T(std::forward<Args>(args)...));
+    } catch (...) {
+        arena.Release();
+        throw;
+    }
+}
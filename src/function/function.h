@@ -0,0 +1,205 @@
+#pragma once
+
+#include <cstddef>  // std::nullptr_t
+#include <exception>
+#include <functional>  // std::invoke
+#include <new>
+#include <type_traits>
+#include <utility>
+
+class BadFunctionCall : public std::exception {};
+
+template <typename Signature, size_t InlineBytes = 2 * sizeof(void*)>
+class UniqueFunction;
+
+// Move-only type-erased callable.
+// Callables that fit into `InlineBytes` (and are nothrow movable) are stored in place, the rest
+// live on the heap. Empty callables always fit, so stateless lambdas never allocate.
+template <typename R, typename... Args, size_t InlineBytes>
+class UniqueFunction<R(Args...), InlineBytes> {
+private:
+    static constexpr size_t kStorageSize =
+        InlineBytes < sizeof(void*) ? sizeof(void*) : InlineBytes;
+    static constexpr size_t kStorageAlign = alignof(void*);
+
+    union Storage {
+        void* heap_;
+        alignas(kStorageAlign) unsigned char bytes_[kStorageSize];
+    };
+
+    template <typename F>
+    static constexpr bool kFitsInline = sizeof(F) <= kStorageSize &&
+                                        alignof(F) <= kStorageAlign &&
+                                        std::is_nothrow_move_constructible_v<F>;
+
+    // Such callables are relocated by copying the storage bytes and need no manager at all.
+    template <typename F>
+    static constexpr bool kIsTrivial =
+        kFitsInline<F> && std::is_trivially_copyable_v<F> && std::is_trivially_destructible_v<F>;
+
+    enum class Operation { kMove, kDestroy };
+
+    using Invoker = R (*)(Storage&, Args&&...);
+    using Manager = void (*)(Operation, Storage& self, Storage* other);
+
+    template <typename F>
+    static F* Target(Storage& storage) {
+        if constexpr (kFitsInline<F>) {
+            return std::launder(reinterpret_cast<F*>(storage.bytes_));
+        } else {
+            return static_cast<F*>(storage.heap_);
+        }
+    }
+
+    // `std::invoke`, so member pointers are called too; a non-void result converts to `R`
+    template <typename F>
+    static R Invoke(Storage& storage, Args&&... args) {
+        if constexpr (std::is_void_v<R>) {
+            std::invoke(*Target<F>(storage), std::forward<Args>(args)...);
+        } else {
+            return std::invoke(*Target<F>(storage), std::forward<Args>(args)...);
+        }
+    }
+
+    static R InvokeEmpty(Storage&, Args&&...) {
+        throw BadFunctionCall();
+    }
+
+    // kMove relocates the callable from `self` into `*other`, kDestroy destroys it in `self`.
+    template <typename F>
+    static void Manage(Operation op, Storage& self, Storage* other) {
+        if constexpr (kFitsInline<F>) {
+            F* target = Target<F>(self);
+            if (op == Operation::kMove) {
+                new (other->bytes_) F(std::move(*target));
+            }
+            target->~F();
+        } else {
+            if (op == Operation::kMove) {
+                other->heap_ = self.heap_;
+            } else {
+                delete Target<F>(self);
+            }
+        }
+    }
+
+    template <typename F>
+    using EnableIfCallable = std::enable_if_t<
+        !std::is_same_v<std::decay_t<F>, UniqueFunction> &&
+        std::is_invocable_r_v<R, std::decay_t<F>&, Args...>>;
+
+public:
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    UniqueFunction() = default;
+
+    UniqueFunction(std::nullptr_t) {
+    }
+
+    template <typename F, typename = EnableIfCallable<F>>
+    UniqueFunction(F&& f) {
+        using Fn = std::decay_t<F>;
+        if constexpr (std::is_pointer_v<Fn> || std::is_member_pointer_v<Fn>) {
+            if (f == nullptr) {
+                return;
+            }
+        }
+
+        if constexpr (kFitsInline<Fn>) {
+            new (storage_.bytes_) Fn(std::forward<F>(f));
+        } else {
+            storage_.heap_ = new Fn(std::forward<F>(f));
+        }
+        invoke_ = &Invoke<Fn>;
+        if constexpr (!kIsTrivial<Fn>) {
+            manage_ = &Manage<Fn>;
+        }
+    }
+
+    UniqueFunction(const UniqueFunction&) = delete;
+
+    UniqueFunction(UniqueFunction&& other) noexcept {
+        MoveFrom(other);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // `operator=`-s
+
+    UniqueFunction& operator=(const UniqueFunction&) = delete;
+
+    UniqueFunction& operator=(UniqueFunction&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            MoveFrom(other);
+        }
+        return *this;
+    }
+
+    UniqueFunction& operator=(std::nullptr_t) {
+        Reset();
+        return *this;
+    }
+
+    template <typename F, typename = EnableIfCallable<F>>
+    UniqueFunction& operator=(F&& f) {
+        UniqueFunction(std::forward<F>(f)).Swap(*this);
+        return *this;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Destructor
+
+    ~UniqueFunction() {
+        Reset();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+
+    void Reset() {
+        if (manage_ != nullptr) {
+            manage_(Operation::kDestroy, storage_, nullptr);
+        }
+        invoke_ = &InvokeEmpty;
+        manage_ = nullptr;
+    }
+
+    void Swap(UniqueFunction& other) noexcept {
+        UniqueFunction temp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(temp);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    // Empty function dispatches to `InvokeEmpty`, so a call is always a single indirect jump.
+    R operator()(Args... args) {
+        return invoke_(storage_, std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const {
+        return invoke_ != &InvokeEmpty;
+    }
+
+private:
+    void MoveFrom(UniqueFunction& other) noexcept {
+        if (other.manage_ != nullptr) {
+            other.manage_(Operation::kMove, other.storage_, &storage_);
+        } else {
+            storage_ = other.storage_;
+        }
+        invoke_ = std::exchange(other.invoke_, &InvokeEmpty);
+        manage_ = std::exchange(other.manage_, nullptr);
+    }
+
+    Invoker invoke_ = &InvokeEmpty;
+    Manager manage_ = nullptr;
+    Storage storage_;
+};
+
+template <typename R, typename... Args, size_t N>
+bool operator==(const UniqueFunction<R(Args...), N>& f, std::nullptr_t) {
+    return !f;
+}
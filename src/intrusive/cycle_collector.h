@@ -0,0 +1,316 @@
+#pragma once
+
+#include "intrusive.h"
+#include <algorithm>  // std::min
+#include <chrono>
+#include <cstddef>  // size_t
+#include <limits>
+#include <type_traits>
+#include <utility>  // std::swap
+#include <vector>
+
+class CycleCollector;
+class CycleTracer;
+
+// Base of objects whose reference cycles are reclaimed by `CycleCollector`.
+// Works with `IntrusivePtr` like `RefCounted`; the object reports its strong references in
+// `Trace` and is destroyed with `delete` (the destructor is virtual).
+class Collectable {
+public:
+    Collectable() = default;
+
+    // Copies are new objects with their own count
+    Collectable(const Collectable&) {
+    }
+
+    Collectable& operator=(const Collectable&) {
+        return *this;
+    }
+
+    void IncRef() {
+        ++count_;
+    }
+
+    // A decrement that leaves the count above zero may have orphaned a cycle,
+    // so the object becomes a candidate root of the thread's collector.
+    void DecRef();
+
+    size_t RefCount() const {
+        return count_;
+    }
+
+    // Calls `tracer(ptr)` for every `IntrusivePtr` to a `Collectable` the object owns
+    virtual void Trace(CycleTracer& tracer) = 0;
+
+protected:
+    virtual ~Collectable() = default;
+
+private:
+    friend class CycleCollector;
+
+    enum class State : unsigned char { kIdle, kScanned, kReachable };
+
+    static constexpr size_t kNotBuffered = std::numeric_limits<size_t>::max();
+
+    size_t count_ = 0;
+    // Position in the candidate buffer
+    size_t root_index_ = kNotBuffered;
+    // References from outside of the scanned subgraph, valid while scanning
+    size_t gc_refs_ = 0;
+    State state_ = State::kIdle;
+};
+
+// Visitor passed to `Collectable::Trace`
+class CycleTracer {
+public:
+    template <typename T>
+    void operator()(IntrusivePtr<T>& ptr) {
+        static_assert(std::is_base_of_v<Collectable, T>);
+        if (!ptr) {
+            return;
+        }
+        if (clear_) {
+            ptr.Reset();
+        } else {
+            visit_(*collector_, ptr.Get());
+        }
+    }
+
+private:
+    friend class CycleCollector;
+
+    using Visit = void (*)(CycleCollector&, Collectable*);
+
+    CycleTracer(CycleCollector& collector, Visit visit, bool clear)
+        : collector_{&collector}, visit_{visit}, clear_{clear} {
+    }
+
+    CycleCollector* collector_;
+    Visit visit_;
+    bool clear_;
+};
+
+// Trial-deletion cycle collector for `Collectable` objects of the current thread.
+// `Collect(budget)` takes candidate roots in small batches and, for each batch, scans the
+// subgraph reachable from it: references coming from inside the subgraph are subtracted from
+// the counts, objects left without outside references and unreachable from the rest are garbage.
+// A batch scans everything reachable from its roots, which may be the whole heap, so the clock
+// is also read while it scans: a batch that runs past the deadline is abandoned, its objects are
+// left as they were and its roots go back to the buffer, and the pause ends within about
+// `kCheckInterval` objects of the budget. The counts may change before the next call, so an
+// abandoned scan is started over rather than resumed; a subgraph too large for the budget is
+// only collected by a larger one or by `CollectAll`.
+class CycleCollector {
+public:
+    static constexpr size_t kBatchSize = 64;
+    // Objects traced between two reads of the clock
+    static constexpr size_t kCheckInterval = 1024;
+
+    struct Stats {
+        size_t scanned = 0;
+        size_t collected = 0;
+        // Batches given up at the deadline
+        size_t abandoned = 0;
+    };
+
+    CycleCollector() = default;
+
+    CycleCollector(const CycleCollector&) = delete;
+    CycleCollector& operator=(const CycleCollector&) = delete;
+
+    // Collector of the current thread
+    static CycleCollector& Local() {
+        thread_local CycleCollector collector;
+        return collector;
+    }
+
+    // Runs batches until the candidates run out or `budget` has passed.
+    // Returns true if every candidate has been processed.
+    bool Collect(std::chrono::nanoseconds budget) {
+        auto deadline = Clock::now() + budget;
+        while (!roots_.empty() && CollectBatch(deadline)) {
+            if (Clock::now() >= deadline) {
+                break;
+            }
+        }
+        return roots_.empty();
+    }
+
+    void CollectAll() {
+        while (!roots_.empty()) {
+            CollectBatch(Clock::time_point::max());
+        }
+    }
+
+    // Number of candidate roots waiting for a scan
+    size_t CandidateCount() const {
+        return roots_.size();
+    }
+
+    const Stats& GetStats() const {
+        return stats_;
+    }
+
+private:
+    friend class Collectable;
+
+    using Clock = std::chrono::steady_clock;
+
+    void AddRoot(Collectable* object) {
+        object->root_index_ = roots_.size();
+        roots_.push_back(object);
+    }
+
+    void RemoveRoot(Collectable* object) {
+        Collectable* last = roots_.back();
+        roots_[object->root_index_] = last;
+        last->root_index_ = object->root_index_;
+        roots_.pop_back();
+        object->root_index_ = Collectable::kNotBuffered;
+    }
+
+    // Puts the roots of an abandoned batch back at the front of the buffer, so the next batches
+    // take other candidates first
+    void Requeue() {
+        for (size_t front = 0; front < batch_.size(); ++front) {
+            AddRoot(batch_[front]);
+            std::swap(roots_[front], roots_.back());
+            roots_[front]->root_index_ = front;
+            roots_.back()->root_index_ = roots_.size() - 1;
+        }
+    }
+
+    // Returns false if the batch was abandoned at `deadline`
+    bool CollectBatch(Clock::time_point deadline) {
+        // Candidates leave the buffer, the live ones come back with their next `DecRef`
+        subgraph_.clear();
+        batch_.clear();
+        size_t batch = std::min(kBatchSize, roots_.size());
+        for (size_t i = 0; i < batch; ++i) {
+            Collectable* root = roots_.back();
+            roots_.pop_back();
+            root->root_index_ = Collectable::kNotBuffered;
+            batch_.push_back(root);
+            Discover(*this, root);
+        }
+
+        size_t until_check = kCheckInterval;
+        auto out_of_time = [&] {
+            if (--until_check != 0) {
+                return false;
+            }
+            until_check = kCheckInterval;
+            return Clock::now() >= deadline;
+        };
+
+        // Explicit worklists keep scanning stack-safe on long chains
+        for (size_t i = 0; i < subgraph_.size(); ++i) {
+            Trace(subgraph_[i], &Discover);
+            if (out_of_time()) {
+                return Abandon();
+            }
+        }
+        for (Collectable* object : subgraph_) {
+            Trace(object, &SubtractInternal);
+            if (out_of_time()) {
+                return Abandon();
+            }
+        }
+        for (Collectable* object : subgraph_) {
+            if (object->gc_refs_ > 0 && object->state_ == Collectable::State::kScanned) {
+                object->state_ = Collectable::State::kReachable;
+                worklist_.push_back(object);
+                while (!worklist_.empty()) {
+                    Collectable* reachable = worklist_.back();
+                    worklist_.pop_back();
+                    Trace(reachable, &MarkReachable);
+                    if (out_of_time()) {
+                        return Abandon();
+                    }
+                }
+            }
+        }
+
+        garbage_.clear();
+        for (Collectable* object : subgraph_) {
+            if (object->state_ == Collectable::State::kScanned) {
+                garbage_.push_back(object);
+            }
+            object->state_ = Collectable::State::kIdle;
+        }
+        stats_.scanned += subgraph_.size();
+        stats_.collected += garbage_.size();
+        subgraph_.clear();
+
+        // Keep every garbage object alive while the cycles are being cut,
+        // then the last `DecRef` destroys it with no references left to follow
+        for (Collectable* object : garbage_) {
+            object->IncRef();
+        }
+        for (Collectable* object : garbage_) {
+            CycleTracer tracer(*this, nullptr, true);
+            object->Trace(tracer);
+        }
+        for (Collectable* object : garbage_) {
+            object->DecRef();
+        }
+        garbage_.clear();
+        return true;
+    }
+
+    // Nothing has been freed yet, so resetting the marks undoes the scan
+    bool Abandon() {
+        for (Collectable* object : subgraph_) {
+            object->state_ = Collectable::State::kIdle;
+        }
+        subgraph_.clear();
+        worklist_.clear();
+        Requeue();
+        ++stats_.abandoned;
+        return false;
+    }
+
+    void Trace(Collectable* object, CycleTracer::Visit visit) {
+        CycleTracer tracer(*this, visit, false);
+        object->Trace(tracer);
+    }
+
+    static void Discover(CycleCollector& collector, Collectable* object) {
+        if (object->state_ == Collectable::State::kIdle) {
+            object->state_ = Collectable::State::kScanned;
+            object->gc_refs_ = object->count_;
+            collector.subgraph_.push_back(object);
+        }
+    }
+
+    static void SubtractInternal(CycleCollector&, Collectable* object) {
+        --object->gc_refs_;
+    }
+
+    static void MarkReachable(CycleCollector& collector, Collectable* object) {
+        if (object->state_ == Collectable::State::kScanned) {
+            object->state_ = Collectable::State::kReachable;
+            collector.worklist_.push_back(object);
+        }
+    }
+
+    std::vector<Collectable*> roots_;
+    // Roots of the running batch
+    std::vector<Collectable*> batch_;
+    std::vector<Collectable*> subgraph_;
+    std::vector<Collectable*> worklist_;
+    std::vector<Collectable*> garbage_;
+    Stats stats_;
+};
+
+inline void Collectable::DecRef() {
+    --count_;
+    if (count_ == 0) {
+        if (root_index_ != kNotBuffered) {
+            CycleCollector::Local().RemoveRoot(this);
+        }
+        delete this;
+    } else if (root_index_ == kNotBuffered) {
+        CycleCollector::Local().AddRoot(this);
+    }
+}
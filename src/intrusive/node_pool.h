@@ -0,0 +1,94 @@
+#pragma once
+
+#include "intrusive.h"
+#include <cstddef>  // size_t
+#include <new>
+#include <utility>
+
+// Per-thread free list of memory blocks for `T`, so structures that churn through many nodes
+// of one type recycle them instead of going to the allocator every time.
+template <typename T>
+class NodePool {
+private:
+    union Block {
+        Block* next;
+        alignas(T) char bytes[sizeof(T)];
+    };
+
+public:
+    static constexpr size_t kMaxPooled = 4096;
+
+    NodePool() = default;
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    ~NodePool() {
+        while (free_ != nullptr) {
+            ::operator delete(std::exchange(free_, free_->next));
+        }
+    }
+
+    // Pool of the current thread
+    static NodePool& Local() {
+        thread_local NodePool pool;
+        return pool;
+    }
+
+    void* Allocate() {
+        if (free_ == nullptr) {
+            return ::operator new(sizeof(Block));
+        }
+        --free_count_;
+        return std::exchange(free_, free_->next);
+    }
+
+    void Deallocate(void* ptr) {
+        if (free_count_ == kMaxPooled) {
+            ::operator delete(ptr);
+            return;
+        }
+        auto* block = static_cast<Block*>(ptr);
+        block->next = free_;
+        free_ = block;
+        ++free_count_;
+    }
+
+    size_t FreeCount() const {
+        return free_count_;
+    }
+
+private:
+    Block* free_ = nullptr;
+    size_t free_count_ = 0;
+};
+
+template <typename T, typename... Args>
+T* NewPooled(Args&&... args) {
+    void* raw = NodePool<T>::Local().Allocate();
+    try {
+        return new (raw) T(std::forward<Args>(args)...);
+    } catch (...) {
+        NodePool<T>::Local().Deallocate(raw);
+        throw;
+    }
+}
+
+template <typename T>
+void DeletePooled(T* object) {
+    object->~T();
+    NodePool<T>::Local().Deallocate(object);
+}
+
+// Deleter policy for `RefCounted` objects created by `MakePooled`
+struct PooledDelete {
+    template <typename T>
+    static void Destroy(T* object) {
+        DeletePooled(object);
+    }
+};
+
+template <typename T, typename... Args>
+IntrusivePtr<T> MakePooled(Args&&... args) {
+    return IntrusivePtr<T>(NewPooled<T>(std::forward<Args>(args)...));
+}
@@ -0,0 +1,262 @@
+#pragma once
+
+#include "../intrusive/intrusive.h"
+#include "../intrusive/node_pool.h"
+#include <algorithm>  // std::find_if
+#include <bit>        // std::popcount
+#include <cstddef>    // size_t
+#include <cstdint>
+#include <functional>  // std::hash, std::equal_to
+#include <utility>
+#include <vector>
+
+// Persistent hash map: a hash array mapped trie of `IntrusivePtr`-linked nodes.
+// Every node consumes 5 bits of the hash and keeps its entries and children in compact arrays
+// indexed by bitmaps; keys whose full hashes collide end up in a collision node searched
+// linearly. Copying the map is O(1), an edit copies only the nodes on its path that other
+// versions share and updates unshared ones in place. `Hash` and `Eq` are stateless functors.
+template <typename K, typename V, typename Hash = std::hash<K>, typename Eq = std::equal_to<K>>
+class PersistentMap {
+private:
+    static constexpr size_t kBits = 5;
+    static constexpr size_t kMask = (size_t{1} << kBits) - 1;
+    static constexpr size_t kHashBits = sizeof(size_t) * 8;
+
+    using Entry = std::pair<K, V>;
+
+    struct Node : RefCounted<Node, SimpleCounter, PooledDelete> {
+        Node() = default;
+
+        // A copy starts with its own reference count
+        Node(const Node& other)
+            : datamap{other.datamap},
+              nodemap{other.nodemap},
+              entries{other.entries},
+              children{other.children} {
+        }
+
+        // Which 5-bit hash fragments have an entry and which have a child node
+        uint32_t datamap = 0;
+        uint32_t nodemap = 0;
+        std::vector<Entry> entries;
+        std::vector<IntrusivePtr<Node>> children;
+    };
+
+public:
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+
+    // Returns true if `key` was not in the map
+    bool Set(K key, V value) {
+        if (!root_) {
+            root_ = MakePooled<Node>();
+        }
+        size_t hash = Hash{}(key);
+        bool inserted = SetIn(root_, 0, hash, Entry(std::move(key), std::move(value)));
+        size_ += inserted;
+        return inserted;
+    }
+
+    // Returns true if `key` was in the map
+    bool Erase(const K& key) {
+        if (Find(key) == nullptr) {
+            return false;
+        }
+        EraseIn(root_, 0, Hash{}(key), key);
+        if (--size_ == 0) {
+            root_.Reset();
+        }
+        return true;
+    }
+
+    void Clear() {
+        root_.Reset();
+        size_ = 0;
+    }
+
+    void Swap(PersistentMap& other) {
+        root_.Swap(other.root_);
+        std::swap(size_, other.size_);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    const V* Find(const K& key) const {
+        size_t hash = Hash{}(key);
+        const Node* node = root_.Get();
+        for (size_t shift = 0; node != nullptr; shift += kBits) {
+            if (shift >= kHashBits) {
+                auto it = FindInCollision(node->entries, key);
+                return it == node->entries.end() ? nullptr : &it->second;
+            }
+            uint32_t bit = Bit(hash, shift);
+            if (node->datamap & bit) {
+                const Entry& entry = node->entries[Index(node->datamap, bit)];
+                return Eq{}(entry.first, key) ? &entry.second : nullptr;
+            }
+            if (!(node->nodemap & bit)) {
+                return nullptr;
+            }
+            node = node->children[Index(node->nodemap, bit)].Get();
+        }
+        return nullptr;
+    }
+
+    bool Contains(const K& key) const {
+        return Find(key) != nullptr;
+    }
+
+    size_t Size() const {
+        return size_;
+    }
+
+    bool Empty() const {
+        return size_ == 0;
+    }
+
+    // Calls `f(key, value)` for every entry in unspecified order
+    template <typename F>
+    void ForEach(F&& f) const {
+        if (root_) {
+            ForEachIn(root_.Get(), f);
+        }
+    }
+
+private:
+    static uint32_t Bit(size_t hash, size_t shift) {
+        return uint32_t{1} << ((hash >> shift) & kMask);
+    }
+
+    // Position of the slot for `bit` among the set bits of `map`
+    static size_t Index(uint32_t map, uint32_t bit) {
+        return std::popcount(map & (bit - 1));
+    }
+
+    template <typename Entries>
+    static auto FindInCollision(Entries& entries, const K& key) {
+        return std::find_if(entries.begin(), entries.end(), [&key](const Entry& entry) {
+            return Eq{}(entry.first, key);
+        });
+    }
+
+    // Node in `slot`, copied first if another version shares it
+    static Node* Editable(IntrusivePtr<Node>& slot) {
+        if (slot.UseCount() != 1) {
+            slot = MakePooled<Node>(*slot);
+        }
+        return slot.Get();
+    }
+
+    static bool SetIn(IntrusivePtr<Node>& slot, size_t shift, size_t hash, Entry&& entry) {
+        Node* node = Editable(slot);
+        if (shift >= kHashBits) {
+            auto it = FindInCollision(node->entries, entry.first);
+            if (it != node->entries.end()) {
+                it->second = std::move(entry.second);
+                return false;
+            }
+            node->entries.push_back(std::move(entry));
+            return true;
+        }
+
+        uint32_t bit = Bit(hash, shift);
+        if (node->nodemap & bit) {
+            return SetIn(node->children[Index(node->nodemap, bit)], shift + kBits, hash,
+                         std::move(entry));
+        }
+        if (!(node->datamap & bit)) {
+            node->entries.insert(node->entries.begin() + Index(node->datamap, bit),
+                                 std::move(entry));
+            node->datamap |= bit;
+            return true;
+        }
+
+        size_t index = Index(node->datamap, bit);
+        Entry& existing = node->entries[index];
+        if (Eq{}(existing.first, entry.first)) {
+            existing.second = std::move(entry.second);
+            return false;
+        }
+        // Two keys share the fragment: both move down into a new child
+        size_t existing_hash = Hash{}(existing.first);
+        IntrusivePtr<Node> child = MergeTwo(shift + kBits, std::move(existing), existing_hash,
+                                            std::move(entry), hash);
+        node->entries.erase(node->entries.begin() + index);
+        node->datamap ^= bit;
+        node->children.insert(node->children.begin() + Index(node->nodemap, bit),
+                              std::move(child));
+        node->nodemap |= bit;
+        return true;
+    }
+
+    static IntrusivePtr<Node> MergeTwo(size_t shift, Entry&& first, size_t first_hash,
+                                       Entry&& second, size_t second_hash) {
+        IntrusivePtr<Node> node = MakePooled<Node>();
+        if (shift >= kHashBits) {
+            node->entries.reserve(2);
+            node->entries.push_back(std::move(first));
+            node->entries.push_back(std::move(second));
+            return node;
+        }
+
+        uint32_t first_bit = Bit(first_hash, shift);
+        uint32_t second_bit = Bit(second_hash, shift);
+        if (first_bit == second_bit) {
+            node->children.push_back(MergeTwo(shift + kBits, std::move(first), first_hash,
+                                              std::move(second), second_hash));
+            node->nodemap = first_bit;
+            return node;
+        }
+        node->entries.reserve(2);
+        if (first_bit > second_bit) {
+            std::swap(first, second);
+        }
+        node->entries.push_back(std::move(first));
+        node->entries.push_back(std::move(second));
+        node->datamap = first_bit | second_bit;
+        return node;
+    }
+
+    // `key` must be in the subtree of `slot`
+    static void EraseIn(IntrusivePtr<Node>& slot, size_t shift, size_t hash, const K& key) {
+        Node* node = Editable(slot);
+        if (shift >= kHashBits) {
+            node->entries.erase(FindInCollision(node->entries, key));
+            return;
+        }
+
+        uint32_t bit = Bit(hash, shift);
+        if (node->datamap & bit) {
+            node->entries.erase(node->entries.begin() + Index(node->datamap, bit));
+            node->datamap ^= bit;
+            return;
+        }
+
+        size_t index = Index(node->nodemap, bit);
+        IntrusivePtr<Node>& child = node->children[index];
+        EraseIn(child, shift + kBits, hash, key);
+        if (!child->children.empty() || child->entries.size() != 1) {
+            return;
+        }
+        // A child left with a single entry is inlined, so lookups stay as short as possible
+        Entry last = std::move(child->entries.front());
+        node->children.erase(node->children.begin() + index);
+        node->nodemap ^= bit;
+        node->entries.insert(node->entries.begin() + Index(node->datamap, bit), std::move(last));
+        node->datamap |= bit;
+    }
+
+    template <typename F>
+    static void ForEachIn(const Node* node, F& f) {
+        for (const Entry& entry : node->entries) {
+            f(entry.first, entry.second);
+        }
+        for (const IntrusivePtr<Node>& child : node->children) {
+            ForEachIn(child.Get(), f);
+        }
+    }
+
+    IntrusivePtr<Node> root_;
+    size_t size_ = 0;
+};
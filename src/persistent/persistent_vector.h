@@ -0,0 +1,252 @@
+#pragma once
+
+#include "../intrusive/intrusive.h"
+#include "../intrusive/node_pool.h"
+#include <algorithm>  // std::min
+#include <array>
+#include <cassert>
+#include <cstddef>  // size_t
+#include <type_traits>
+#include <utility>
+
+// Persistent vector: a 32-way trie of `IntrusivePtr`-linked nodes plus a separate tail leaf.
+// Copying the vector is O(1) and shares every node. An edit copies the O(log32 n) nodes on its
+// path that are shared with other versions and updates the rest in place, so a vector that has
+// no snapshots behaves like a transient: batch edits touch no allocator at all.
+template <typename T>
+class PersistentVector {
+    static_assert(std::is_default_constructible_v<T> && std::is_copy_assignable_v<T>,
+                  "Leaves store `T`s in fixed arrays");
+
+private:
+    static constexpr size_t kBits = 5;
+    static constexpr size_t kWidth = size_t{1} << kBits;
+    static constexpr size_t kMask = kWidth - 1;
+
+    struct Node;
+
+    struct NodeDelete {
+        static void Destroy(Node* node) {
+            PersistentVector::DestroyNode(node);
+        }
+    };
+
+    struct Node : RefCounted<Node, SimpleCounter, NodeDelete> {
+        explicit Node(bool leaf) : is_leaf{leaf} {
+        }
+
+        // A copy starts with its own reference count
+        Node(const Node& other) : Node(other.is_leaf) {
+        }
+
+        bool is_leaf;
+    };
+
+    struct Leaf : Node {
+        Leaf() : Node(true) {
+        }
+
+        std::array<T, kWidth> values;
+    };
+
+    struct Inner : Node {
+        Inner() : Node(false) {
+        }
+
+        std::array<IntrusivePtr<Node>, kWidth> children;
+    };
+
+public:
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+
+    void PushBack(T value) {
+        size_t tail_size = size_ - TailOffset();
+        if (tail_size == kWidth) {
+            // The tail is full: move it into the trie, growing a new root level if needed
+            IntrusivePtr<Node> full = std::move(tail_);
+            if (!root_) {
+                root_ = MakePooled<Inner>();
+            }
+            if ((size_ >> kBits) > (size_t{1} << shift_)) {
+                IntrusivePtr<Node> root = MakePooled<Inner>();
+                static_cast<Inner*>(root.Get())->children[0] = std::move(root_);
+                static_cast<Inner*>(root.Get())->children[1] = NewPath(shift_, std::move(full));
+                root_ = std::move(root);
+                shift_ += kBits;
+            } else {
+                PushTail(root_, shift_, std::move(full));
+            }
+            tail_size = 0;
+        }
+        if (!tail_) {
+            tail_ = MakePooled<Leaf>();
+        }
+        Editable<Leaf>(tail_)->values[tail_size] = std::move(value);
+        ++size_;
+    }
+
+    void PopBack() {
+        assert(size_ > 0);
+        size_t tail_size = size_ - TailOffset();
+        if (tail_size > 1) {
+            Editable<Leaf>(tail_)->values[tail_size - 1] = T();
+            --size_;
+            return;
+        }
+        if (size_ == 1) {
+            Clear();
+            return;
+        }
+
+        // The tail empties: the last leaf of the trie becomes the new tail
+        IntrusivePtr<Node> tail = LeafSlot(size_ - 2);
+        if (PopTail(root_, shift_)) {
+            root_.Reset();
+        } else if (shift_ > kBits && !static_cast<Inner*>(root_.Get())->children[1]) {
+            IntrusivePtr<Node> child = static_cast<Inner*>(root_.Get())->children[0];
+            root_ = std::move(child);
+            shift_ -= kBits;
+        }
+        tail_ = std::move(tail);
+        --size_;
+    }
+
+    void Set(size_t i, T value) {
+        assert(i < size_);
+        if (i >= TailOffset()) {
+            Editable<Leaf>(tail_)->values[i & kMask] = std::move(value);
+            return;
+        }
+        IntrusivePtr<Node>* slot = &root_;
+        for (size_t level = shift_; level > 0; level -= kBits) {
+            slot = &Editable<Inner>(*slot)->children[(i >> level) & kMask];
+        }
+        Editable<Leaf>(*slot)->values[i & kMask] = std::move(value);
+    }
+
+    void Clear() {
+        root_.Reset();
+        tail_.Reset();
+        size_ = 0;
+        shift_ = kBits;
+    }
+
+    void Swap(PersistentVector& other) {
+        root_.Swap(other.root_);
+        tail_.Swap(other.tail_);
+        std::swap(size_, other.size_);
+        std::swap(shift_, other.shift_);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    const T& operator[](size_t i) const {
+        assert(i < size_);
+        return static_cast<const Leaf*>(LeafFor(i))->values[i & kMask];
+    }
+
+    const T& Back() const {
+        return (*this)[size_ - 1];
+    }
+
+    size_t Size() const {
+        return size_;
+    }
+
+    bool Empty() const {
+        return size_ == 0;
+    }
+
+    // Calls `f(value)` for every element in order, one leaf lookup per 32 elements
+    template <typename F>
+    void ForEach(F&& f) const {
+        for (size_t base = 0; base < size_; base += kWidth) {
+            const Leaf* leaf = static_cast<const Leaf*>(LeafFor(base));
+            size_t count = std::min(kWidth, size_ - base);
+            for (size_t i = 0; i < count; ++i) {
+                f(leaf->values[i]);
+            }
+        }
+    }
+
+private:
+    static void DestroyNode(Node* node) {
+        if (node->is_leaf) {
+            DeletePooled(static_cast<Leaf*>(node));
+        } else {
+            DeletePooled(static_cast<Inner*>(node));
+        }
+    }
+
+    // Node in `slot`, copied first if another version shares it
+    template <typename N>
+    static N* Editable(IntrusivePtr<Node>& slot) {
+        if (slot.UseCount() != 1) {
+            slot = MakePooled<N>(static_cast<const N&>(*slot));
+        }
+        return static_cast<N*>(slot.Get());
+    }
+
+    static IntrusivePtr<Node> NewPath(size_t level, IntrusivePtr<Node> leaf) {
+        if (level == 0) {
+            return leaf;
+        }
+        IntrusivePtr<Node> node = MakePooled<Inner>();
+        static_cast<Inner*>(node.Get())->children[0] = NewPath(level - kBits, std::move(leaf));
+        return node;
+    }
+
+    // Index of the first element in the tail
+    size_t TailOffset() const {
+        return size_ == 0 ? 0 : (size_ - 1) & ~kMask;
+    }
+
+    const Node* LeafFor(size_t i) const {
+        if (i >= TailOffset()) {
+            return tail_.Get();
+        }
+        const Node* node = root_.Get();
+        for (size_t level = shift_; level > 0; level -= kBits) {
+            node = static_cast<const Inner*>(node)->children[(i >> level) & kMask].Get();
+        }
+        return node;
+    }
+
+    IntrusivePtr<Node> LeafSlot(size_t i) const {
+        return IntrusivePtr<Node>(const_cast<Node*>(LeafFor(i)));
+    }
+
+    // Appends the full tail as the leaf for elements [size_ - 32, size_)
+    void PushTail(IntrusivePtr<Node>& slot, size_t level, IntrusivePtr<Node> leaf) {
+        Inner* inner = Editable<Inner>(slot);
+        size_t index = ((size_ - 1) >> level) & kMask;
+        if (level == kBits) {
+            inner->children[index] = std::move(leaf);
+        } else if (inner->children[index]) {
+            PushTail(inner->children[index], level - kBits, std::move(leaf));
+        } else {
+            inner->children[index] = NewPath(level - kBits, std::move(leaf));
+        }
+    }
+
+    // Drops the leaf holding element `size_ - 2`, returns true if `slot` is left empty
+    bool PopTail(IntrusivePtr<Node>& slot, size_t level) {
+        Inner* inner = Editable<Inner>(slot);
+        size_t index = ((size_ - 2) >> level) & kMask;
+        if (level > kBits) {
+            bool emptied = PopTail(inner->children[index], level - kBits);
+            if (!emptied) {
+                return false;
+            }
+        }
+        inner->children[index].Reset();
+        return index == 0;
+    }
+
+    IntrusivePtr<Node> root_;
+    IntrusivePtr<Node> tail_;
+    size_t size_ = 0;
+    size_t shift_ = kBits;
+};
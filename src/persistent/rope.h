@@ -0,0 +1,292 @@
+#pragma once
+
+#include "../intrusive/intrusive.h"
+#include "../intrusive/node_pool.h"
+#include "../trailing/trailing.h"
+#include <algorithm>  // std::min, std::max
+#include <cassert>
+#include <cstddef>  // size_t
+#include <cstring>  // std::memcpy
+#include <string>
+#include <string_view>
+#include <utility>
+
+// Persistent text buffer: an AVL-balanced tree of `IntrusivePtr`-linked nodes whose leaves are
+// slices of immutable refcounted chunks. Insert, erase, substring and concatenation are
+// O(log n) splits and joins that share every untouched subtree and chunk with the source, so
+// copying a rope is O(1) and old versions stay valid after edits.
+class Rope {
+private:
+    // Longest slice of an input string stored in one leaf
+    static constexpr size_t kMaxLeaf = 1024;
+    // Adjacent leaves at most this long together are copied into one chunk on join,
+    // so character-by-character edits do not fragment the tree
+    static constexpr size_t kMergeLimit = 128;
+
+    struct Chunk : SimpleRefCounted<Chunk, TrailingDelete>, WithTrailing<Chunk, char> {};
+
+    struct Node : SimpleRefCounted<Node, PooledDelete> {
+        size_t length = 0;
+        size_t height = 0;
+        // Inner nodes
+        IntrusivePtr<Node> left;
+        IntrusivePtr<Node> right;
+        // Leaves: `length` characters at `data` inside `chunk`
+        IntrusivePtr<Chunk> chunk;
+        const char* data = nullptr;
+
+        bool IsLeaf() const {
+            return chunk.Get() != nullptr;
+        }
+    };
+
+    using NodePtr = IntrusivePtr<Node>;
+
+    explicit Rope(NodePtr root) : root_{std::move(root)} {
+    }
+
+public:
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    Rope() = default;
+
+    // Copies `text` once into a single chunk shared by all the leaves
+    explicit Rope(std::string_view text) {
+        if (text.empty()) {
+            return;
+        }
+        IntrusivePtr<Chunk> chunk = MakeIntrusiveWithTrailing<Chunk>(text.size());
+        std::memcpy(chunk->Trailing().data(), text.data(), text.size());
+        size_t leaves = (text.size() + kMaxLeaf - 1) / kMaxLeaf;
+        root_ = Build(chunk, chunk->Trailing().data(), text.size(), leaves);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+
+    void Insert(size_t pos, const Rope& other) {
+        assert(pos <= Size());
+        auto [left, right] = Split(root_, pos);
+        root_ = Join(Join(left, other.root_), right);
+    }
+
+    void Insert(size_t pos, std::string_view text) {
+        Insert(pos, Rope(text));
+    }
+
+    void Append(const Rope& other) {
+        root_ = Join(root_, other.root_);
+    }
+
+    void Append(std::string_view text) {
+        Append(Rope(text));
+    }
+
+    // Erases up to `count` characters starting at `pos`
+    void Erase(size_t pos, size_t count) {
+        assert(pos <= Size());
+        count = std::min(count, Size() - pos);
+        auto [left, rest] = Split(root_, pos);
+        auto [erased, right] = Split(rest, count);
+        root_ = Join(left, right);
+    }
+
+    void Clear() {
+        root_.Reset();
+    }
+
+    void Swap(Rope& other) {
+        root_.Swap(other.root_);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    // Up to `count` characters starting at `pos`, sharing the chunks with this rope
+    Rope Substr(size_t pos, size_t count) const {
+        assert(pos <= Size());
+        count = std::min(count, Size() - pos);
+        NodePtr rest = Split(root_, pos).second;
+        return Rope(Split(rest, count).first);
+    }
+
+    char operator[](size_t i) const {
+        assert(i < Size());
+        const Node* node = root_.Get();
+        while (!node->IsLeaf()) {
+            if (i < node->left->length) {
+                node = node->left.Get();
+            } else {
+                i -= node->left->length;
+                node = node->right.Get();
+            }
+        }
+        return node->data[i];
+    }
+
+    size_t Size() const {
+        return root_ ? root_->length : 0;
+    }
+
+    bool Empty() const {
+        return Size() == 0;
+    }
+
+    // Height of the tree, 0 for a single leaf
+    size_t Height() const {
+        return Height(root_);
+    }
+
+    // Calls `f(std::string_view)` for every leaf in order, without copying characters
+    template <typename F>
+    void ForEachChunk(F&& f) const {
+        if (root_) {
+            ForEachChunkIn(root_.Get(), f);
+        }
+    }
+
+    std::string ToString() const {
+        std::string result;
+        result.reserve(Size());
+        ForEachChunk([&result](std::string_view chunk) {
+            result.append(chunk);
+        });
+        return result;
+    }
+
+    friend Rope operator+(const Rope& lhs, const Rope& rhs) {
+        return Rope(Join(lhs.root_, rhs.root_));
+    }
+
+private:
+    static size_t Height(const NodePtr& node) {
+        return node ? node->height : 0;
+    }
+
+    static NodePtr MakeLeaf(IntrusivePtr<Chunk> chunk, const char* data, size_t length) {
+        NodePtr leaf = MakePooled<Node>();
+        leaf->length = length;
+        leaf->chunk = std::move(chunk);
+        leaf->data = data;
+        return leaf;
+    }
+
+    static NodePtr MakeInner(NodePtr left, NodePtr right) {
+        NodePtr inner = MakePooled<Node>();
+        inner->length = left->length + right->length;
+        inner->height = std::max(left->height, right->height) + 1;
+        inner->left = std::move(left);
+        inner->right = std::move(right);
+        return inner;
+    }
+
+    // Balanced tree over `leaves` consecutive slices of `length` characters at `data`
+    static NodePtr Build(const IntrusivePtr<Chunk>& chunk, const char* data, size_t length,
+                         size_t leaves) {
+        if (leaves == 1) {
+            return MakeLeaf(chunk, data, length);
+        }
+        size_t left_leaves = leaves / 2;
+        size_t left_length = left_leaves * kMaxLeaf;
+        return MakeInner(Build(chunk, data, left_length, left_leaves),
+                         Build(chunk, data + left_length, length - left_length,
+                               leaves - left_leaves));
+    }
+
+    static bool Mergeable(const NodePtr& left, const NodePtr& right) {
+        return left->IsLeaf() && right->IsLeaf() && left->length + right->length <= kMergeLimit;
+    }
+
+    static NodePtr MergeLeaves(const NodePtr& left, const NodePtr& right) {
+        size_t length = left->length + right->length;
+        IntrusivePtr<Chunk> chunk = MakeIntrusiveWithTrailing<Chunk>(length);
+        char* data = chunk->Trailing().data();
+        std::memcpy(data, left->data, left->length);
+        std::memcpy(data + left->length, right->data, right->length);
+        return MakeLeaf(std::move(chunk), data, length);
+    }
+
+    // Inner node over `left` and `right` whose heights differ by at most 2, rotated back into
+    // AVL shape if needed
+    static NodePtr Balance(NodePtr left, NodePtr right) {
+        if (Height(right) > Height(left) + 1) {
+            if (Height(right->left) > Height(right->right)) {
+                const NodePtr& middle = right->left;
+                return MakeInner(MakeInner(std::move(left), middle->left),
+                                 MakeInner(middle->right, right->right));
+            }
+            return MakeInner(MakeInner(std::move(left), right->left), right->right);
+        }
+        if (Height(left) > Height(right) + 1) {
+            if (Height(left->right) > Height(left->left)) {
+                const NodePtr& middle = left->right;
+                return MakeInner(MakeInner(left->left, middle->left),
+                                 MakeInner(middle->right, std::move(right)));
+            }
+            return MakeInner(left->left, MakeInner(left->right, std::move(right)));
+        }
+        return MakeInner(std::move(left), std::move(right));
+    }
+
+    // Concatenation in O(|height difference|): the shorter tree is hung on the spine of the
+    // taller one at a subtree of its own height
+    static NodePtr Join(const NodePtr& left, const NodePtr& right) {
+        if (!left) {
+            return right;
+        }
+        if (!right) {
+            return left;
+        }
+        if (Mergeable(left, right)) {
+            return MergeLeaves(left, right);
+        }
+        if (left->height > right->height + 1) {
+            return Balance(left->left, Join(left->right, right));
+        }
+        if (right->height > left->height + 1) {
+            return Balance(Join(left, right->left), right->right);
+        }
+        // Small edits meet the neighbouring leaf here
+        if (!left->IsLeaf() && Mergeable(left->right, right)) {
+            return Balance(left->left, MergeLeaves(left->right, right));
+        }
+        if (!right->IsLeaf() && Mergeable(left, right->left)) {
+            return Balance(MergeLeaves(left, right->left), right->right);
+        }
+        return MakeInner(left, right);
+    }
+
+    // First `pos` characters and the rest
+    static std::pair<NodePtr, NodePtr> Split(const NodePtr& node, size_t pos) {
+        if (!node || pos == 0) {
+            return {nullptr, node};
+        }
+        if (pos >= node->length) {
+            return {node, nullptr};
+        }
+        if (node->IsLeaf()) {
+            return {MakeLeaf(node->chunk, node->data, pos),
+                    MakeLeaf(node->chunk, node->data + pos, node->length - pos)};
+        }
+        size_t left_length = node->left->length;
+        if (pos < left_length) {
+            auto [left, right] = Split(node->left, pos);
+            return {std::move(left), Join(right, node->right)};
+        }
+        auto [left, right] = Split(node->right, pos - left_length);
+        return {Join(node->left, left), std::move(right)};
+    }
+
+    template <typename F>
+    static void ForEachChunkIn(const Node* node, F& f) {
+        if (node->IsLeaf()) {
+            f(std::string_view(node->data, node->length));
+            return;
+        }
+        ForEachChunkIn(node->left.Get(), f);
+        ForEachChunkIn(node->right.Get(), f);
+    }
+
+    NodePtr root_;
+};
@@ -0,0 +1,305 @@
+#pragma once
+
+#include "shared_span.h"
+#include <algorithm>  // std::min
+#include <cstring>    // std::memcpy
+#include <sys/uio.h>  // iovec
+#include <utility>
+#include <vector>
+
+// Header of one segment in a `BufferChain`: a refcounted slice plus a link to the next one.
+struct BufferSegment {
+    SharedBytes bytes;
+    BufferSegment* next = nullptr;
+};
+
+// Free list of segment headers, so building and dropping chains does not hit the allocator.
+class SegmentPool {
+public:
+    static constexpr size_t kMaxPooled = 4096;
+
+    SegmentPool() = default;
+
+    SegmentPool(const SegmentPool&) = delete;
+    SegmentPool& operator=(const SegmentPool&) = delete;
+
+    ~SegmentPool() {
+        while (free_ != nullptr) {
+            delete std::exchange(free_, free_->next);
+        }
+    }
+
+    // Pool of the current thread
+    static SegmentPool& Local() {
+        thread_local SegmentPool pool;
+        return pool;
+    }
+
+    BufferSegment* Acquire(SharedBytes&& bytes) {
+        BufferSegment* segment = free_;
+        if (segment == nullptr) {
+            segment = new BufferSegment;
+        } else {
+            free_ = segment->next;
+            --free_count_;
+        }
+        segment->bytes = std::move(bytes);
+        segment->next = nullptr;
+        return segment;
+    }
+
+    void Release(BufferSegment* segment) {
+        segment->bytes.Reset();
+        if (free_count_ == kMaxPooled) {
+            delete segment;
+            return;
+        }
+        segment->next = free_;
+        free_ = segment;
+        ++free_count_;
+    }
+
+    size_t FreeCount() const {
+        return free_count_;
+    }
+
+private:
+    BufferSegment* free_ = nullptr;
+    size_t free_count_ = 0;
+};
+
+// IOBuf-like sequence of refcounted byte slices.
+// Appending, splitting and trimming move segment headers around and never copy the payload;
+// `Coalesce` copies only when the data spans several segments.
+class BufferChain {
+public:
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    BufferChain() = default;
+
+    explicit BufferChain(SharedBytes bytes) {
+        Append(std::move(bytes));
+    }
+
+    BufferChain(const BufferChain&) = delete;
+
+    BufferChain(BufferChain&& other) noexcept
+        : head_{std::exchange(other.head_, nullptr)},
+          tail_{std::exchange(other.tail_, nullptr)},
+          size_{std::exchange(other.size_, 0)},
+          segment_count_{std::exchange(other.segment_count_, 0)},
+          reserved_{std::move(other.reserved_)} {
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // `operator=`-s
+
+    BufferChain& operator=(const BufferChain&) = delete;
+
+    BufferChain& operator=(BufferChain&& other) noexcept {
+        if (this != &other) {
+            Clear();
+            Swap(other);
+        }
+        return *this;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Destructor
+
+    ~BufferChain() {
+        Clear();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+
+    void Append(SharedBytes bytes) {
+        if (bytes.Empty()) {
+            return;
+        }
+        size_ += bytes.Size();
+        ++segment_count_;
+        Link(SegmentPool::Local().Acquire(std::move(bytes)));
+    }
+
+    // Splices all segments of `other` to the end, `other` becomes empty
+    void Append(BufferChain&& other) {
+        if (other.head_ == nullptr) {
+            return;
+        }
+        Link(other.head_);
+        tail_ = other.tail_;
+        size_ += other.size_;
+        segment_count_ += other.segment_count_;
+
+        other.head_ = other.tail_ = nullptr;
+        other.size_ = other.segment_count_ = 0;
+    }
+
+    // Detaches the first `count` bytes into a new chain
+    BufferChain Split(size_t count) {
+        assert(count <= size_);
+        BufferChain front;
+        while (count > 0) {
+            SharedBytes& bytes = head_->bytes;
+            if (bytes.Size() <= count) {
+                count -= bytes.Size();
+                front.Append(PopFront());
+            } else {
+                front.Append(bytes.First(count));
+                bytes = bytes.Subspan(count);
+                size_ -= count;
+                count = 0;
+            }
+        }
+        return front;
+    }
+
+    // Drops the first `count` bytes
+    void TrimFront(size_t count) {
+        Split(count);
+    }
+
+    // Makes the content contiguous and returns it. Copies only if there is more than one segment.
+    SharedBytes Coalesce() {
+        if (segment_count_ > 1) {
+            SharedSpan<std::byte> joined = MakeSharedSpanForOverwrite<std::byte>(size_);
+            size_t offset = 0;
+            ForEachSegment([&](const SharedBytes& bytes) {
+                std::memcpy(joined.Data() + offset, bytes.Data(), bytes.Size());
+                offset += bytes.Size();
+            });
+            Clear();
+            Append(std::move(joined));
+        }
+        return head_ == nullptr ? SharedBytes() : head_->bytes;
+    }
+
+    // New chain that shares the payload of this one
+    BufferChain Clone() const {
+        BufferChain copy;
+        ForEachSegment([&copy](const SharedBytes& bytes) { copy.Append(bytes); });
+        return copy;
+    }
+
+    void Clear() {
+        while (head_ != nullptr) {
+            SegmentPool::Local().Release(std::exchange(head_, head_->next));
+        }
+        tail_ = nullptr;
+        size_ = segment_count_ = 0;
+    }
+
+    void Swap(BufferChain& other) {
+        std::swap(head_, other.head_);
+        std::swap(tail_, other.tail_);
+        std::swap(size_, other.size_);
+        std::swap(segment_count_, other.segment_count_);
+        std::swap(reserved_, other.reserved_);
+    }
+
+    // Reserves a fresh segment of `segment_size` bytes for every entry of `iov` and points the
+    // entry at it, for `readv`. Nobody else shares these segments, so unlike `FillIovecs` they
+    // may be written through; they join the content only in `CommitRead`.
+    void ReserveIovecs(std::span<iovec> iov, size_t segment_size) {
+        reserved_.clear();
+        for (iovec& entry : iov) {
+            reserved_.push_back(MakeSharedSpanForOverwrite<std::byte>(segment_size));
+            entry.iov_base = reserved_.back().Data();
+            entry.iov_len = segment_size;
+        }
+    }
+
+    // Appends the first `count` bytes of the reserved segments (what `readv` returned) and drops
+    // the reservation, segments left empty included
+    void CommitRead(size_t count) {
+        for (const SharedSpan<std::byte>& segment : reserved_) {
+            if (count == 0) {
+                break;
+            }
+            size_t filled = std::min(count, segment.Size());
+            Append(segment.First(filled));
+            count -= filled;
+        }
+        assert(count == 0);
+        reserved_.clear();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    // Total number of bytes
+    size_t Size() const {
+        return size_;
+    }
+
+    bool Empty() const {
+        return size_ == 0;
+    }
+
+    size_t SegmentCount() const {
+        return segment_count_;
+    }
+
+    template <typename F>
+    void ForEachSegment(F&& f) const {
+        for (BufferSegment* segment = head_; segment != nullptr; segment = segment->next) {
+            f(static_cast<const SharedBytes&>(segment->bytes));
+        }
+    }
+
+    // Fills `iov` with the first segments for `writev`, returns the number of filled entries.
+    // The entries are for output only: segments are shared with other chains and slices, so they
+    // must never be passed to `readv` (see `ReserveIovecs`) or otherwise written through.
+    size_t FillIovecs(std::span<iovec> iov) const {
+        size_t count = 0;
+        for (BufferSegment* segment = head_; segment != nullptr && count < iov.size();
+             segment = segment->next) {
+            // `writev` takes non-const pointers, but never writes through them
+            iov[count].iov_base = const_cast<std::byte*>(segment->bytes.Data());
+            iov[count].iov_len = segment->bytes.Size();
+            ++count;
+        }
+        return count;
+    }
+
+    // Same as `FillIovecs`, output only
+    std::vector<iovec> ToIovecs() const {
+        std::vector<iovec> iov(segment_count_);
+        FillIovecs(iov);
+        return iov;
+    }
+
+private:
+    void Link(BufferSegment* segment) {
+        if (tail_ == nullptr) {
+            head_ = segment;
+        } else {
+            tail_->next = segment;
+        }
+        tail_ = segment;
+    }
+
+    SharedBytes PopFront() {
+        BufferSegment* segment = head_;
+        head_ = segment->next;
+        if (head_ == nullptr) {
+            tail_ = nullptr;
+        }
+        size_ -= segment->bytes.Size();
+        --segment_count_;
+
+        SharedBytes bytes = std::move(segment->bytes);
+        SegmentPool::Local().Release(segment);
+        return bytes;
+    }
+
+    BufferSegment* head_ = nullptr;
+    BufferSegment* tail_ = nullptr;
+    size_t size_ = 0;
+    size_t segment_count_ = 0;
+    // Segments handed out by `ReserveIovecs` and not committed yet
+    std::vector<SharedSpan<std::byte>> reserved_;
+};
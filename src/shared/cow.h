@@ -0,0 +1,125 @@
+#pragma once
+
+#include "../unique/unique.h"
+#include "shared.h"
+#include <type_traits>
+#include <utility>  // std::in_place
+
+// Moves the object out of `ptr` if it is the only owner and returns it in a fresh `UniquePtr`.
+// Otherwise returns null and leaves `ptr` untouched. The object cannot be released from its
+// control block (`MakeShared` co-allocates them), so it is moved rather than re-owned; that is
+// why `T` must be movable and not polymorphic, since a `SharedPtr<T>` may point to a derived
+// object that a move into a new `T` would slice.
+template <typename T>
+UniquePtr<T> TryUnwrap(SharedPtr<T>&& ptr) {
+    static_assert(std::is_move_constructible_v<T> && !std::is_polymorphic_v<T>,
+                  "TryUnwrap moves the object into a new T");
+    if (ptr.UseCount() != 1) {
+        return UniquePtr<T>();
+    }
+    UniquePtr<T> result(new T(std::move(*ptr)));
+    ptr.Reset();
+    return result;
+}
+
+// Value-semantic handle to a shared `T`: copies share the object, `Mutate()` copies it first
+// only if somebody else may still see it. The `SharedPtr` never leaves the class as non-const,
+// but a `WeakPtr` taken from a `Share()` snapshot outlives the snapshot, so an edit happens in
+// place only when there are neither other owners nor weak references.
+// Clones are copies into a new `T`, so `T` must be copyable and not polymorphic.
+template <typename T>
+class CowPtr {
+    static_assert(std::is_copy_constructible_v<T> && !std::is_polymorphic_v<T>,
+                  "CowPtr copies the object into a new T");
+
+public:
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    CowPtr() : data_{MakeShared<T>()} {
+    }
+
+    explicit CowPtr(T value) : data_{MakeShared<T>(std::move(value))} {
+    }
+
+    template <typename... Args>
+    explicit CowPtr(std::in_place_t, Args&&... args)
+        : data_{MakeShared<T>(std::forward<Args>(args)...)} {
+    }
+
+    CowPtr(const CowPtr&) = default;
+
+    // A moved-from handle may only be assigned to or destroyed
+    CowPtr(CowPtr&&) = default;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // `operator=`-s
+
+    CowPtr& operator=(const CowPtr&) = default;
+
+    CowPtr& operator=(CowPtr&&) = default;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+
+    // Mutable access. Clones the object if it is shared, so the other handles keep the old value.
+    // The counts are read with acquire loads, so other threads may drop their copies and
+    // snapshots meanwhile; they must not turn a snapshot into a `WeakPtr` or lock one at the same
+    // time, since no pair of loads can see that happen between them.
+    T& Mutate() {
+        if (data_.WeakCount() != 0 || data_.UseCount() != 1) {
+            data_ = MakeShared<T>(static_cast<const T&>(*data_));
+        }
+        return *data_;
+    }
+
+    // Takes the object out, copying it if it is shared. The handle is left empty.
+    UniquePtr<T> Release() && {
+        UniquePtr<T> result = TryUnwrap(std::move(data_));
+        if (!result) {
+            result = UniquePtr<T>(new T(static_cast<const T&>(*data_)));
+            data_.Reset();
+        }
+        return result;
+    }
+
+    void Swap(CowPtr& other) {
+        data_.Swap(other.data_);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    const T* Get() const {
+        return data_.Get();
+    }
+
+    const T& operator*() const {
+        return *data_;
+    }
+
+    const T* operator->() const {
+        return data_.Get();
+    }
+
+    // Read-only snapshot sharing the current object
+    SharedPtr<const T> Share() const {
+        return data_;
+    }
+
+    bool Unique() const {
+        return data_.UseCount() == 1;
+    }
+
+    size_t UseCount() const {
+        return data_.UseCount();
+    }
+
+private:
+    SharedPtr<T> data_;
+};
+
+template <typename T, typename... Args>
+CowPtr<T> MakeCow(Args&&... args) {
+    return CowPtr<T>(std::in_place, std::forward<Args>(args)...);
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "../weak/weak.h"
+#include "shared.h"
+#include <array>
+#include <cstddef>  // size_t
+#include <cstdint>
+#include <functional>  // std::hash, std::equal_to
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Hash-consing table: `Intern(value)` returns the live `SharedPtr<const T>` equal to `value` if
+// there is one and a new one otherwise, so equal immutable values share a single instance.
+// The table holds only `WeakPtr`s and never extends a lifetime; entries of destroyed values are
+// dropped lazily by the probes that pass over them and by rehashing.
+//
+// Every shard is an open-addressing table (linear probing) with its own lock, so threads may
+// intern at the same time and copy or drop the handles they get while others do.
+template <typename T, typename Hash = std::hash<T>, typename Eq = std::equal_to<T>>
+class Interner {
+private:
+    static constexpr size_t kShardBits = 4;
+    static constexpr size_t kShardCount = size_t{1} << kShardBits;
+    static constexpr size_t kMinCapacity = 16;
+
+    enum class SlotState : uint8_t { kEmpty, kFull, kDeleted };
+
+    struct Slot {
+        size_t hash = 0;
+        WeakPtr<const T> value;
+        SlotState state = SlotState::kEmpty;
+    };
+
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::vector<Slot> slots;
+        // Full and deleted slots, both lengthen probes
+        size_t used = 0;
+        size_t live = 0;
+    };
+
+public:
+    Interner() = default;
+
+    Interner(const Interner&) = delete;
+    Interner& operator=(const Interner&) = delete;
+
+    SharedPtr<const T> Intern(const T& value) {
+        return InternImpl(value);
+    }
+
+    SharedPtr<const T> Intern(T&& value) {
+        return InternImpl(std::move(value));
+    }
+
+    // Number of entries, including expired ones not purged yet
+    size_t EntryCount() {
+        size_t count = 0;
+        for (Shard& shard : shards_) {
+            std::lock_guard lock(shard.mutex);
+            count += shard.live;
+        }
+        return count;
+    }
+
+    // Drops every expired entry now
+    void Purge() {
+        for (Shard& shard : shards_) {
+            std::lock_guard lock(shard.mutex);
+            Rehash(shard);
+        }
+    }
+
+private:
+    // Spreads poor hashes (e.g. identity for integers) over shards and slots
+    static size_t Mix(size_t hash) {
+        hash *= 0x9E3779B97F4A7C15ull;
+        return hash ^ (hash >> 32);
+    }
+
+    static size_t StartIndex(const Shard& shard, size_t hash) {
+        return (hash >> kShardBits) & (shard.slots.size() - 1);
+    }
+
+    template <typename U>
+    SharedPtr<const T> InternImpl(U&& value) {
+        size_t hash = Mix(Hash{}(value));
+        Shard& shard = shards_[hash & (kShardCount - 1)];
+        std::lock_guard lock(shard.mutex);
+        if ((shard.used + 1) * 4 > shard.slots.size() * 3) {
+            Rehash(shard);
+        }
+
+        size_t mask = shard.slots.size() - 1;
+        Slot* free = nullptr;
+        size_t index = StartIndex(shard, hash);
+        for (;; index = (index + 1) & mask) {
+            Slot& slot = shard.slots[index];
+            if (slot.state == SlotState::kEmpty) {
+                break;
+            }
+            if (slot.state == SlotState::kFull && slot.value.Expired()) {
+                // Releasing the weak reference frees the control block of the dead value
+                slot.value.Reset();
+                slot.state = SlotState::kDeleted;
+                --shard.live;
+            }
+            if (slot.state == SlotState::kDeleted) {
+                if (free == nullptr) {
+                    free = &slot;
+                }
+                continue;
+            }
+            if (slot.hash == hash) {
+                // The value may have died on another thread since the check above
+                SharedPtr<const T> existing = slot.value.Lock();
+                if (existing && Eq{}(*existing, value)) {
+                    return existing;
+                }
+            }
+        }
+
+        SharedPtr<const T> result = MakeShared<T>(std::forward<U>(value));
+        if (free == nullptr) {
+            free = &shard.slots[index];
+            ++shard.used;
+        }
+        free->hash = hash;
+        free->value = WeakPtr<const T>(result);
+        free->state = SlotState::kFull;
+        ++shard.live;
+        return result;
+    }
+
+    // Rebuilds the shard with room for twice its live entries, dropping expired ones
+    static void Rehash(Shard& shard) {
+        std::vector<Slot> old = std::move(shard.slots);
+        size_t live = 0;
+        for (const Slot& slot : old) {
+            live += slot.state == SlotState::kFull && !slot.value.Expired();
+        }
+        size_t capacity = kMinCapacity;
+        while (capacity < (live + 1) * 2) {
+            capacity *= 2;
+        }
+
+        shard.slots = std::vector<Slot>(capacity);
+        size_t mask = capacity - 1;
+        for (Slot& slot : old) {
+            if (slot.state != SlotState::kFull || slot.value.Expired()) {
+                continue;
+            }
+            size_t index = StartIndex(shard, slot.hash);
+            while (shard.slots[index].state != SlotState::kEmpty) {
+                index = (index + 1) & mask;
+            }
+            shard.slots[index] = std::move(slot);
+        }
+        shard.used = live;
+        shard.live = live;
+    }
+
+    std::array<Shard, kShardCount> shards_;
+};
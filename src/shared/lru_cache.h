@@ -0,0 +1,251 @@
+#pragma once
+
+#include "../weak/weak.h"
+#include "shared.h"
+#include <algorithm>  // std::max
+#include <cassert>
+#include <cstddef>     // size_t
+#include <functional>  // std::hash
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Byte-weighted cache of `SharedPtr<V>` values split into independently locked shards.
+// Every shard evicts with CLOCK: a hit only sets the entry's reference bit, and the hand sweeping
+// the entries gives referenced ones a second chance. Evicting drops only the cache's reference,
+// so callers holding a value keep it valid; the key then moves to a side index of `WeakPtr`s,
+// and a `Get` for it brings the value back while anyone still holds it.
+template <typename K, typename V, typename Hash = std::hash<K>>
+class SharedLruCache {
+public:
+    struct Stats {
+        size_t hits = 0;
+        size_t misses = 0;
+        // Hits served from the `WeakPtr` index after eviction
+        size_t resurrections = 0;
+        size_t evictions = 0;
+    };
+
+private:
+    struct Entry {
+        K key;
+        SharedPtr<V> value;
+        size_t weight = 0;
+        bool referenced = false;
+    };
+
+    struct Evicted {
+        WeakPtr<V> value;
+        size_t weight = 0;
+    };
+
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        // Resident entries live in `slots`, the clock hand walks over them
+        std::vector<Entry> slots;
+        std::vector<size_t> free_slots;
+        std::unordered_map<K, size_t, Hash> index;
+        std::unordered_map<K, Evicted, Hash> evicted;
+        size_t hand = 0;
+        size_t weight = 0;
+        // Size of `evicted` that triggers a sweep for expired values
+        size_t prune_at = 16;
+        Stats stats;
+    };
+
+public:
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    // Every shard holds up to `capacity / shard_count` bytes; a `shard_count` of 0 means 1
+    explicit SharedLruCache(size_t capacity, size_t shard_count = 16)
+        : shard_capacity_{capacity / std::max<size_t>(shard_count, 1)},
+          shards_(std::max<size_t>(shard_count, 1)) {
+    }
+
+    SharedLruCache(const SharedLruCache&) = delete;
+    SharedLruCache& operator=(const SharedLruCache&) = delete;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+
+    // Inserts or replaces the value of `key`, charging `weight` bytes
+    void Put(const K& key, SharedPtr<V> value, size_t weight = sizeof(V)) {
+        assert(value);
+        Shard& shard = ShardFor(key);
+        std::lock_guard lock(shard.mutex);
+        shard.evicted.erase(key);
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            Entry& entry = shard.slots[it->second];
+            shard.weight = shard.weight - entry.weight + weight;
+            entry.value = std::move(value);
+            entry.weight = weight;
+        } else {
+            Insert(shard, key, std::move(value), weight);
+        }
+        EvictOverCapacity(shard);
+    }
+
+    // Returns true if `key` was resident or still alive after eviction
+    bool Erase(const K& key) {
+        Shard& shard = ShardFor(key);
+        std::lock_guard lock(shard.mutex);
+        bool erased = false;
+        auto evicted = shard.evicted.find(key);
+        if (evicted != shard.evicted.end()) {
+            erased = !evicted->second.value.Expired();
+            shard.evicted.erase(evicted);
+        }
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            Remove(shard, it->second);
+            erased = true;
+        }
+        return erased;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    // Null if the key is neither resident nor held by anyone
+    SharedPtr<V> Get(const K& key) {
+        Shard& shard = ShardFor(key);
+        std::lock_guard lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            ++shard.stats.hits;
+            Entry& entry = shard.slots[it->second];
+            entry.referenced = true;
+            return entry.value;
+        }
+
+        auto evicted = shard.evicted.find(key);
+        if (evicted != shard.evicted.end()) {
+            SharedPtr<V> value = evicted->second.value.Lock();
+            size_t weight = evicted->second.weight;
+            shard.evicted.erase(evicted);
+            if (value) {
+                ++shard.stats.resurrections;
+                Insert(shard, key, value, weight);
+                shard.slots[shard.index.at(key)].referenced = true;
+                EvictOverCapacity(shard);
+                return value;
+            }
+        }
+        ++shard.stats.misses;
+        return SharedPtr<V>();
+    }
+
+    // Bytes charged for resident entries
+    size_t Weight() {
+        size_t weight = 0;
+        for (Shard& shard : shards_) {
+            std::lock_guard lock(shard.mutex);
+            weight += shard.weight;
+        }
+        return weight;
+    }
+
+    size_t Size() {
+        size_t size = 0;
+        for (Shard& shard : shards_) {
+            std::lock_guard lock(shard.mutex);
+            size += shard.index.size();
+        }
+        return size;
+    }
+
+    Stats GetStats() {
+        Stats total;
+        for (Shard& shard : shards_) {
+            std::lock_guard lock(shard.mutex);
+            total.hits += shard.stats.hits;
+            total.misses += shard.stats.misses;
+            total.resurrections += shard.stats.resurrections;
+            total.evictions += shard.stats.evictions;
+        }
+        return total;
+    }
+
+private:
+    Shard& ShardFor(const K& key) {
+        // The low bits pick the bucket inside the shard's map, the high ones pick the shard
+        size_t hash = Hash{}(key) * 0x9E3779B97F4A7C15ull;
+        return shards_[(hash >> 32) % shards_.size()];
+    }
+
+    static void Insert(Shard& shard, const K& key, SharedPtr<V> value, size_t weight) {
+        size_t slot;
+        if (shard.free_slots.empty()) {
+            slot = shard.slots.size();
+            shard.slots.push_back(Entry{key, std::move(value), weight, false});
+        } else {
+            slot = shard.free_slots.back();
+            shard.slots[slot] = Entry{key, std::move(value), weight, false};
+            shard.free_slots.pop_back();
+        }
+        try {
+            shard.index.emplace(key, slot);
+        } catch (...) {
+            shard.slots[slot].value.Reset();
+            shard.free_slots.push_back(slot);
+            throw;
+        }
+        shard.weight += weight;
+    }
+
+    static void Remove(Shard& shard, size_t slot) {
+        Entry& entry = shard.slots[slot];
+        shard.index.erase(entry.key);
+        shard.weight -= entry.weight;
+        entry.value.Reset();
+        entry.weight = 0;
+        shard.free_slots.push_back(slot);
+    }
+
+    // Free slots are the ones without a value
+    static bool IsFree(const Shard& shard, size_t slot) {
+        return !shard.slots[slot].value;
+    }
+
+    void EvictOverCapacity(Shard& shard) {
+        while (shard.weight > shard_capacity_ && !shard.index.empty()) {
+            size_t slot = shard.hand;
+            shard.hand = (shard.hand + 1) % shard.slots.size();
+            if (IsFree(shard, slot)) {
+                continue;
+            }
+            Entry& entry = shard.slots[slot];
+            if (entry.referenced) {
+                entry.referenced = false;
+                continue;
+            }
+            ++shard.stats.evictions;
+            // Values nobody holds are gone for good, the rest stay reachable through the index.
+            // Without the shard lock nobody can take a new reference, only drop one, so a stale
+            // count at worst keeps a key whose value has just died.
+            if (entry.value.UseCount() > 1) {
+                shard.evicted[entry.key] = Evicted{WeakPtr<V>(entry.value), entry.weight};
+            }
+            Remove(shard, slot);
+        }
+        PruneEvicted(shard);
+    }
+
+    // Keeps the side index from growing with keys whose values are long gone
+    static void PruneEvicted(Shard& shard) {
+        if (shard.evicted.size() <= shard.prune_at) {
+            return;
+        }
+        std::erase_if(shard.evicted, [](const auto& item) {
+            return item.second.value.Expired();
+        });
+        // Values still held stay, so the next sweep waits until the index doubles
+        shard.prune_at = std::max(2 * shard.index.size() + 16, 2 * shard.evicted.size());
+    }
+
+    size_t shard_capacity_;
+    std::vector<Shard> shards_;
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "shared_span.h"
+#include <cerrno>
+#include <fcntl.h>     // open
+#include <string>
+#include <sys/mman.h>  // mmap, munmap, madvise
+#include <sys/stat.h>  // fstat
+#include <system_error>
+#include <unistd.h>    // close, sysconf
+
+// Access pattern hints, see madvise(2)
+enum class MapAdvice { kNormal, kRandom, kSequential, kWillNeed, kDontNeed };
+
+struct MapOptions {
+    MapAdvice advice = MapAdvice::kNormal;
+    // Prefault the whole mapping (MAP_POPULATE), trades open latency for no page faults later
+    bool populate = false;
+};
+
+// Unmaps the region when the last `SharedPtr` to it dies
+class MunmapDeleter {
+public:
+    explicit MunmapDeleter(size_t length) : length_(length) {
+    }
+
+    void operator()(const std::byte* ptr) const {
+        munmap(const_cast<std::byte*>(ptr), length_);
+    }
+
+private:
+    size_t length_;
+};
+
+inline int ToMadvise(MapAdvice advice) {
+    switch (advice) {
+        case MapAdvice::kRandom:
+            return MADV_RANDOM;
+        case MapAdvice::kSequential:
+            return MADV_SEQUENTIAL;
+        case MapAdvice::kWillNeed:
+            return MADV_WILLNEED;
+        case MapAdvice::kDontNeed:
+            return MADV_DONTNEED;
+        default:
+            return MADV_NORMAL;
+    }
+}
+
+// Applies `advice` to the pages covering `bytes`, which must point into a mapping
+inline void AdviseMapped(const SharedBytes& bytes, MapAdvice advice) {
+    if (bytes.Empty()) {
+        return;
+    }
+    static const uintptr_t kPageMask = sysconf(_SC_PAGESIZE) - 1;
+    auto begin = reinterpret_cast<uintptr_t>(bytes.Data()) & ~kPageMask;
+    auto end = reinterpret_cast<uintptr_t>(bytes.Data() + bytes.Size());
+    if (madvise(reinterpret_cast<void*>(begin), end - begin, ToMadvise(advice)) != 0) {
+        throw std::system_error(errno, std::generic_category(), "madvise");
+    }
+}
+
+// Maps the file at `path` read-only. The mapping is owned by the control block of the result,
+// so slices of it keep the whole mapping alive. Throws `std::system_error` on failure.
+inline SharedBytes MapShared(const std::string& path, MapOptions options = {}) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "open " + path);
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        int error = errno;
+        close(fd);
+        throw std::system_error(error, std::generic_category(), "fstat " + path);
+    }
+
+    size_t length = info.st_size;
+    if (length == 0) {
+        close(fd);
+        return SharedBytes();
+    }
+
+    int flags = MAP_PRIVATE | (options.populate ? MAP_POPULATE : 0);
+    void* addr = mmap(nullptr, length, PROT_READ, flags, fd, 0);
+    int error = errno;
+    close(fd);
+    if (addr == MAP_FAILED) {
+        throw std::system_error(error, std::generic_category(), "mmap " + path);
+    }
+
+    SharedPtr<const std::byte[]> mapping(static_cast<const std::byte*>(addr),
+                                         MunmapDeleter(length));
+    SharedBytes bytes(mapping, length);
+    if (options.advice != MapAdvice::kNormal) {
+        AdviseMapped(bytes, options.advice);
+    }
+    return bytes;
+}
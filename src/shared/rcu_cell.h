@@ -0,0 +1,182 @@
+#pragma once
+
+#include "shared.h"
+#include <algorithm>  // std::find
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Registry of reader threads shared by all `RcuCell`s.
+// Every reader thread owns a cache-line sized slot holding the epoch it entered its read-side
+// critical section in (0 while outside), so readers never write to memory other threads write.
+class RcuDomain {
+private:
+    struct alignas(64) ReaderSlot {
+        std::atomic<uint64_t> epoch = 0;
+        // Depth of nested read sections, touched only by the owning thread
+        size_t depth = 0;
+    };
+
+    // Registers the slot on first use and removes it when the thread exits
+    class ThreadSlot {
+    public:
+        ThreadSlot() {
+            RcuDomain::Global().Register(&slot_);
+        }
+
+        ~ThreadSlot() {
+            RcuDomain::Global().Unregister(&slot_);
+        }
+
+        ReaderSlot slot_;
+    };
+
+public:
+    static RcuDomain& Global() {
+        static RcuDomain domain;
+        return domain;
+    }
+
+    void ReadLock() {
+        ReaderSlot& slot = LocalSlot();
+        if (slot.depth++ == 0) {
+            slot.epoch.store(epoch_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            // Pairs with the fence in `Synchronize`: either the writer sees this slot busy,
+            // or this thread sees the pointer published before the writer's fence
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    void ReadUnlock() {
+        ReaderSlot& slot = LocalSlot();
+        if (--slot.depth == 0) {
+            slot.epoch.store(0, std::memory_order_release);
+        }
+    }
+
+    // Waits until every read section that could see data unpublished before the call is over
+    void Synchronize() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint64_t target = epoch_.fetch_add(1) + 1;
+
+        std::lock_guard lock(registry_mutex_);
+        for (ReaderSlot* slot : readers_) {
+            while (true) {
+                uint64_t epoch = slot->epoch.load(std::memory_order_acquire);
+                if (epoch == 0 || epoch >= target) {
+                    break;
+                }
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    RcuDomain() = default;
+
+    static ReaderSlot& LocalSlot() {
+        thread_local ThreadSlot slot;
+        return slot.slot_;
+    }
+
+    void Register(ReaderSlot* slot) {
+        std::lock_guard lock(registry_mutex_);
+        readers_.push_back(slot);
+    }
+
+    void Unregister(ReaderSlot* slot) {
+        std::lock_guard lock(registry_mutex_);
+        readers_.erase(std::find(readers_.begin(), readers_.end(), slot));
+    }
+
+    // Starts at 1, 0 marks an idle slot
+    std::atomic<uint64_t> epoch_ = 1;
+    std::mutex registry_mutex_;
+    std::vector<ReaderSlot*> readers_;
+};
+
+// Read-mostly cell holding a `SharedPtr<const T>` snapshot.
+// Readers borrow `const T&` inside a `ReadGuard`: one load and a write to their own slot, no
+// reference count traffic. `Publish` swaps in a new snapshot and keeps the old one alive until
+// every reader that could still see it has left its read section.
+//
+// Readers never touch the reference counts, which stay on the write side; writers are
+// serialized by the cell.
+template <typename T>
+class RcuCell {
+public:
+    // Keeps the snapshot it was created from readable until destroyed
+    class ReadGuard {
+    public:
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+        ~ReadGuard() {
+            RcuDomain::Global().ReadUnlock();
+        }
+
+        const T* Get() const {
+            return ptr_;
+        }
+
+        const T& operator*() const {
+            return *ptr_;
+        }
+
+        const T* operator->() const {
+            return ptr_;
+        }
+
+    private:
+        friend class RcuCell;
+
+        explicit ReadGuard(const std::atomic<const T*>& current) {
+            RcuDomain::Global().ReadLock();
+            ptr_ = current.load(std::memory_order_acquire);
+        }
+
+        const T* ptr_;
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    explicit RcuCell(SharedPtr<const T> initial)
+        : owner_{std::move(initial)}, current_{owner_.Get()} {
+    }
+
+    RcuCell(const RcuCell&) = delete;
+    RcuCell& operator=(const RcuCell&) = delete;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Read side
+
+    ReadGuard Read() const {
+        return ReadGuard(current_);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Write side
+
+    // Publishes `next` and returns after the previous snapshot has been released.
+    // Must not be called from inside a read section of the same thread.
+    void Publish(SharedPtr<const T> next) {
+        std::lock_guard lock(writer_mutex_);
+        current_.store(next.Get(), std::memory_order_release);
+        SharedPtr<const T> retired = std::exchange(owner_, std::move(next));
+        RcuDomain::Global().Synchronize();
+    }
+
+    template <typename... Args>
+    void Emplace(Args&&... args) {
+        Publish(MakeShared<T>(std::forward<Args>(args)...));
+    }
+
+private:
+    std::mutex writer_mutex_;
+    SharedPtr<const T> owner_;
+    std::atomic<const T*> current_;
+};
@@ -1,7 +1,13 @@
 #pragma once
 
+#include "../unique/compressed_tuple.h"
 #include "sw_fwd.h"  // Forward declaration
-#include <cstddef>   // std::nullptr_t
+#include <atomic>
+#include <cstddef>     // std::nullptr_t
+#include <functional>  // std::less, std::hash
+#include <limits>
+#include <memory>  // std::allocator, std::allocator_traits
+#include <new>     // std::bad_array_new_length
 #include <type_traits>
 
 // the base class for Enable Shared From This
@@ -12,68 +18,95 @@ class ESFTBase {};
 // Base class for other control blocks
 class IBlock {
 private:
-    size_t shared_count_ = 1;
-    size_t weak_count_ = 0;
+    // Set in `weak_count_` while the block has expiry listeners (see `expiry.h`), so blocks
+    // without listeners stay the same size and pay one branch when the object dies
+    static constexpr size_t kListenedFlag = size_t{1} << (sizeof(size_t) * 8 - 1);
+
+    // Installed by `ExpiryRegistry` when the first listener is registered
+    static inline std::atomic<void (*)(IBlock*)> expiry_hook_ = nullptr;
+
+    // Atomic like those of `std::shared_ptr`, so owners may be copied and dropped on any thread.
+    // All the shared references together hold one weak reference, so the block outlives the
+    // object's destructor and is freed by whichever count reaches zero last.
+    std::atomic<size_t> shared_count_ = 1;
+    std::atomic<size_t> weak_count_ = 1;
 
     virtual void Deleter() {};
 
+    friend class ExpiryRegistry;
+
 public:
-    IBlock() {
-        shared_count_ = 1;
-        weak_count_ = 0;
-    }
+    IBlock() = default;
+
     // api for shared obj refs
 
-    size_t SharedCount() {
-        return shared_count_;
+    size_t SharedCount() const {
+        return shared_count_.load(std::memory_order_acquire);
     }
 
     void IncShared() {
-        ++shared_count_;
+        shared_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Takes a shared reference unless the object is already dead (`WeakPtr::Lock`)
+    bool TryIncShared() {
+        size_t count = shared_count_.load(std::memory_order_relaxed);
+        while (count != 0) {
+            if (shared_count_.compare_exchange_weak(count, count + 1, std::memory_order_acquire,
+                                                    std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
     }
 
     void DecShared() {
-        // std::cout << "DecShared() strong: " << shared_count_ << ", weak: " << weak_count_ <<
-        // "\n";
-        --shared_count_;
-        if (shared_count_ == 0) {
-            // std::cout << "DecShared Deleter()\n";
+        if (shared_count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            // The object may hold weak refs to its own block (`EnableSharedFromThis`), the one
+            // held by the shared references keeps the block alive until it is fully destroyed.
             Deleter();
-            // if (WeakCount() == 0) {
-            //     std::cout << "Deleting object: " << this << std::endl;
-            //     delete this;
-            // }
+            if (weak_count_.load(std::memory_order_acquire) & kListenedFlag) {
+                expiry_hook_.load(std::memory_order_acquire)(this);
+            }
+            DecWeak();
         }
     }
 
     // api for weak obj refs
-    size_t WeakCount() {
-        return weak_count_;
+    size_t WeakCount() const {
+        size_t count = weak_count_.load(std::memory_order_acquire) & ~kListenedFlag;
+        return SharedCount() != 0 ? count - 1 : count;
     }
 
     void IncWeak() {
-        weak_count_++;
+        weak_count_.fetch_add(1, std::memory_order_relaxed);
     }
 
     void DecWeak() {
-        weak_count_--;
-        // std::cout << "DecWeak() strong: " << shared_count_ << ", weak: " << weak_count_ << "\n";
-        if (shared_count_ == 0 && WeakCount() == 0) {
-            // std::cout << "Deleting object: " << this << std::endl;
-            delete this;
+        if ((weak_count_.fetch_sub(1, std::memory_order_acq_rel) & ~kListenedFlag) == 1) {
+            Destroy();
         }
     }
 
     // virtual methods
+    // Frees the block itself; overridden by blocks that are not allocated with plain `new`.
+    virtual void Destroy() {
+        delete this;
+    }
+
     virtual ~IBlock(){};
 };
 
 // Control Block for shared_ptr(T* ptr)
-template <typename T>
+template <typename T, bool IsArray = false>
 class RawPtrBlock : public IBlock {
 private:
     void Deleter() override {
-        delete ptr_;
+        if constexpr (IsArray) {
+            delete[] ptr_;
+        } else {
+            delete ptr_;
+        }
     }
 
 public:
@@ -86,6 +119,45 @@ public:
     }
 };
 
+// Control Block for shared_ptr(T* ptr, D deleter, A alloc)
+// Stateless deleters and allocators take no space inside `CompressedTuple`.
+template <typename T, typename D, typename A>
+class DeleterBlock : public IBlock {
+private:
+    using BlockAllocator = typename std::allocator_traits<A>::template rebind_alloc<DeleterBlock>;
+    using BlockTraits = std::allocator_traits<BlockAllocator>;
+
+    void Deleter() override {
+        data_.template Get<1>()(data_.template Get<0>());
+    }
+
+    void Destroy() override {
+        BlockAllocator alloc(data_.template Get<2>());
+        BlockTraits::destroy(alloc, this);
+        BlockTraits::deallocate(alloc, this, 1);
+    }
+
+public:
+    CompressedTuple<T*, D, A> data_;
+
+    DeleterBlock(T* ptr, D&& deleter, A&& alloc)
+        : IBlock(), data_{ptr, std::move(deleter), std::move(alloc)} {};
+
+    // Like `std::shared_ptr`, calls `deleter(ptr)` if the block cannot be allocated.
+    static DeleterBlock* Create(T* ptr, D deleter, A alloc) {
+        BlockAllocator block_alloc(alloc);
+        DeleterBlock* block = nullptr;
+        try {
+            block = BlockTraits::allocate(block_alloc, 1);
+        } catch (...) {
+            deleter(ptr);
+            throw;
+        }
+        BlockTraits::construct(block_alloc, block, ptr, std::move(deleter), std::move(alloc));
+        return block;
+    }
+};
+
 // Control Block for make_shared(Args&&...)
 template <typename T>
 class SingleAllocateBlock : public IBlock {
@@ -95,7 +167,7 @@ private:
     };
 
 public:
-    char bytes_[sizeof(T)] = {};
+    alignas(T) char bytes_[sizeof(T)];
     T* ptr_ = nullptr;
 
     SingleAllocateBlock() : IBlock() {
@@ -111,9 +183,120 @@ public:
     }
 };
 
+// Payloads of this size and above are not co-allocated with the control block by `MakeShared`,
+// arrays of `MakeShared<T[]>` included. A `WeakPtr` keeps the whole block alive, so an expired
+// large object would pin its bytes; allocated separately they are freed as soon as the last
+// `SharedPtr` dies.
+inline constexpr size_t kSplitPayloadThreshold = 16 << 10;
+
+// Specialize to force the split (or co-allocation) for a particular type
+template <typename T>
+struct SplitMakeSharedPayload : std::bool_constant<(sizeof(T) >= kSplitPayloadThreshold)> {};
+
+// Control Block for make_shared<T[]>(size)
+// The elements are placed right after the block, so the whole array is a single allocation,
+// unless they take `kSplitPayloadThreshold` bytes or more.
+template <typename T>
+class ArrayAllocateBlock : public IBlock {
+private:
+    static constexpr size_t ElementsOffset() {
+        return (sizeof(ArrayAllocateBlock) + alignof(T) - 1) / alignof(T) * alignof(T);
+    }
+
+    // Where co-allocated elements start
+    static T* InlineElements(void* block) {
+        return reinterpret_cast<T*>(static_cast<char*>(block) + ElementsOffset());
+    }
+
+    void Deleter() override {
+        std::destroy_n(ptr_, size_);
+        if (ptr_ != InlineElements(this)) {
+            ::operator delete(static_cast<void*>(ptr_));
+        }
+    }
+
+    void Destroy() override {
+        this->~ArrayAllocateBlock();
+        ::operator delete(static_cast<void*>(this));
+    }
+
+    ArrayAllocateBlock(T* elements, size_t size) : IBlock(), ptr_{elements}, size_{size} {
+    }
+
+    // `init(ptr, size)` constructs the elements
+    template <typename Init>
+    static ArrayAllocateBlock* CreateWith(size_t size, Init init) {
+        static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+        // Like `new T[size]`, a length whose byte count wraps around is refused
+        if (size > (std::numeric_limits<size_t>::max() - ElementsOffset()) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        bool split = size * sizeof(T) >= kSplitPayloadThreshold;
+        void* raw = ::operator new(ElementsOffset() + (split ? 0 : size * sizeof(T)));
+        T* elements = InlineElements(raw);
+        if (split) {
+            try {
+                elements = static_cast<T*>(::operator new(size * sizeof(T)));
+            } catch (...) {
+                ::operator delete(raw);
+                throw;
+            }
+        }
+        try {
+            init(elements, size);
+        } catch (...) {
+            if (split) {
+                ::operator delete(static_cast<void*>(elements));
+            }
+            ::operator delete(raw);
+            throw;
+        }
+        return new (raw) ArrayAllocateBlock(elements, size);
+    }
+
+public:
+    T* ptr_ = nullptr;
+    size_t size_ = 0;
+
+    static ArrayAllocateBlock* Create(size_t size) {
+        return CreateWith(size,
+                          [](T* ptr, size_t n) { std::uninitialized_value_construct_n(ptr, n); });
+    }
+
+    // Default-initialized elements: trivial types are left uninitialized
+    static ArrayAllocateBlock* CreateForOverwrite(size_t size) {
+        return CreateWith(size,
+                          [](T* ptr, size_t n) { std::uninitialized_default_construct_n(ptr, n); });
+    }
+
+    // Every element is constructed from `args...`
+    template <typename... Args>
+    static ArrayAllocateBlock* Emplace(size_t size, const Args&... args) {
+        return CreateWith(size, [&](T* ptr, size_t n) {
+            size_t constructed = 0;
+            try {
+                for (; constructed < n; ++constructed) {
+                    new (ptr + constructed) T(args...);
+                }
+            } catch (...) {
+                std::destroy_n(ptr, constructed);
+                throw;
+            }
+        });
+    }
+
+    static ArrayAllocateBlock* Create(size_t size, const T& value) {
+        return CreateWith(size,
+                          [&value](T* ptr, size_t n) { std::uninitialized_fill_n(ptr, n, value); });
+    }
+};
+
 template <typename T>
 class SharedPtr {
 public:
+    // `T` for single objects, `U` for `SharedPtr<U[]>`
+    using ElementType = std::remove_extent_t<T>;
+
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // Constructors
 
@@ -141,7 +324,18 @@ public:
     }
 
     template <typename Y>
-    explicit SharedPtr(Y* ptr) : ptr_{ptr}, ctrl_block_{new RawPtrBlock<Y>(ptr)} {
+    SharedPtr(ArrayAllocateBlock<Y>* ctrl_block)
+        : ptr_{ctrl_block->ptr_}, ctrl_block_{ctrl_block} {
+    }
+
+    // Adopts the initial reference of a freshly created `ctrl_block` that owns `*ptr`.
+    // For custom control blocks, e.g. groups of objects sharing one block.
+    SharedPtr(IBlock* ctrl_block, ElementType* ptr) : ptr_{ptr}, ctrl_block_{ctrl_block} {
+    }
+
+    template <typename Y>
+    explicit SharedPtr(Y* ptr)
+        : ptr_{ptr}, ctrl_block_{new RawPtrBlock<Y, std::is_array_v<T>>(ptr)} {
         // std::cout << "SharedPtr(T* ptr)" << "\n";
         if constexpr (std::is_convertible_v<Y*, ESFTBase*>) {
             // std::cout << "BEFORE WEAK THIS: strong: " << ctrl_block_->SharedCount() << ", weak: "
@@ -152,6 +346,16 @@ public:
         // weak: " << ctrl_block_->WeakCount() << "\n";
     };
 
+    template <typename Y, typename D, typename A = std::allocator<std::remove_cv_t<Y>>,
+              typename = std::enable_if_t<std::is_invocable_v<D&, Y*>>>
+    SharedPtr(Y* ptr, D deleter, A alloc = A())
+        : ptr_{ptr},
+          ctrl_block_{DeleterBlock<Y, D, A>::Create(ptr, std::move(deleter), std::move(alloc))} {
+        if constexpr (std::is_convertible_v<Y*, ESFTBase*>) {
+            ptr_->weak_this_ = WeakPtr<T>(*this);
+        }
+    };
+
     // copy contructor for working   SharedPtr<const int> s2 = s1;
     template <typename Y>
     SharedPtr(const SharedPtr<Y>& other) : ptr_{other.ptr_}, ctrl_block_{other.ctrl_block_} {
@@ -192,7 +396,7 @@ public:
     // Aliasing constructor
     // #8 from https://en.cppreference.com/w/cpp/memory/shared_ptr/shared_ptr
     template <typename Y>
-    SharedPtr(const SharedPtr<Y>& other, T* ptr) {
+    SharedPtr(const SharedPtr<Y>& other, ElementType* ptr) {
         // std::cout << "SharedPtr(SharedPtr<Y>&other, T* ptr)" << "\n";
         ptr_ = ptr;
         ctrl_block_ = other.ctrl_block_;
@@ -205,17 +409,13 @@ public:
     // Promote `WeakPtr`
     // #11 from https://en.cppreference.com/w/cpp/memory/shared_ptr/shared_ptr
     explicit SharedPtr(const WeakPtr<T>& other) {
-        if (other.Expired()) {
+        // The object may die on another thread between a check and an increment
+        if (other.ctrl_block_ == nullptr || !other.ctrl_block_->TryIncShared()) {
             throw BadWeakPtr();
-            return;
         }
 
         ptr_ = other.ptr_;
         ctrl_block_ = other.ctrl_block_;
-
-        if (ctrl_block_ != nullptr) {
-            ctrl_block_->IncShared();
-        }
     };
 
     ////////////////////////////////////////////////////////////////////////////////////////////////
@@ -263,12 +463,7 @@ public:
 
     void Reset() {
         if (ctrl_block_ != nullptr) {
-            ctrl_block_->IncWeak();
             ctrl_block_->DecShared();
-            ctrl_block_->DecWeak();
-            if (ctrl_block_->SharedCount() == 0 && ctrl_block_->WeakCount() == 0) {
-                delete ctrl_block_;
-            }
         }
 
         ptr_ = nullptr;
@@ -279,7 +474,7 @@ public:
     void Reset(Y* ptr) {
         Reset();
         ptr_ = ptr;
-        ctrl_block_ = new RawPtrBlock<Y>(ptr);
+        ctrl_block_ = new RawPtrBlock<Y, std::is_array_v<T>>(ptr);
     };
 
     template <typename Y>
@@ -296,7 +491,7 @@ public:
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // Observers
 
-    T* Get() const {
+    ElementType* Get() const {
         return ptr_;
     };
 
@@ -304,10 +499,15 @@ public:
         return *ptr_;
     };
 
-    T* operator->() const {
+    ElementType* operator->() const {
         return ptr_;
     };
 
+    template <typename U = T, typename = std::enable_if_t<std::is_array_v<U>>>
+    ElementType& operator[](size_t i) const {
+        return ptr_[i];
+    };
+
     size_t UseCount() const {
         if (ctrl_block_ != nullptr) {
             return ctrl_block_->SharedCount();
@@ -315,12 +515,47 @@ public:
         return 0;
     };
 
+    // Number of `WeakPtr`s to the object
+    size_t WeakCount() const {
+        if (ctrl_block_ != nullptr) {
+            return ctrl_block_->WeakCount();
+        }
+        return 0;
+    };
+
     explicit operator bool() const {
         return ptr_ != nullptr;
     };
 
+    // Ordering, equality and hashing by control block ("owner"): every `SharedPtr` and `WeakPtr`
+    // sharing ownership of an object agrees, aliasing pointers included, and the results do not
+    // change when the object expires. See `owner.h` for functors.
+    template <typename Y>
+    bool OwnerBefore(const SharedPtr<Y>& other) const {
+        return std::less<const IBlock*>()(ctrl_block_, other.ctrl_block_);
+    };
+
+    template <typename Y>
+    bool OwnerBefore(const WeakPtr<Y>& other) const {
+        return std::less<const IBlock*>()(ctrl_block_, other.ctrl_block_);
+    };
+
+    template <typename Y>
+    bool OwnerEqual(const SharedPtr<Y>& other) const {
+        return ctrl_block_ == other.ctrl_block_;
+    };
+
+    template <typename Y>
+    bool OwnerEqual(const WeakPtr<Y>& other) const {
+        return ctrl_block_ == other.ctrl_block_;
+    };
+
+    size_t OwnerHash() const {
+        return std::hash<const IBlock*>()(ctrl_block_);
+    };
+
 private:
-    T* ptr_ = nullptr;
+    ElementType* ptr_ = nullptr;
     IBlock* ctrl_block_ = nullptr;
 
     // fiend class
@@ -332,6 +567,8 @@ private:
 
     template <typename Y>
     friend class WeakPtr;
+
+    friend class ExpiryRegistry;
 };
 
 template <typename T, typename U>
@@ -339,11 +576,32 @@ inline bool operator==(const SharedPtr<T>& left, const SharedPtr<U>& right) {
     return left.Get() == right.Get();
 };
 
-// Allocate memory only once
+// Allocate memory only once (large payloads excepted, see `SplitMakeSharedPayload`)
+// `MakeShared<T[]>(size)` value-initializes the elements, `MakeShared<T[]>(size, value)` fills
+// them.
 template <typename T, typename... Args>
 SharedPtr<T> MakeShared(Args&&... args) {
-    // std::cout << "SharedPtr(ControlBlock)\n";
-    return SharedPtr<T>(new SingleAllocateBlock<T>(std::forward<Args>(args)...));
+    if constexpr (std::is_array_v<T>) {
+        return SharedPtr<T>(
+            ArrayAllocateBlock<std::remove_extent_t<T>>::Create(std::forward<Args>(args)...));
+    } else if constexpr (SplitMakeSharedPayload<T>::value) {
+        // The same block as for `SharedPtr(new T)`, but the object must not leak if it throws
+        T* ptr = new T(std::forward<Args>(args)...);
+        try {
+            return SharedPtr<T>(ptr);
+        } catch (...) {
+            delete ptr;
+            throw;
+        }
+    } else {
+        return SharedPtr<T>(new SingleAllocateBlock<T>(std::forward<Args>(args)...));
+    }
+};
+
+// Like `MakeShared<T[]>(size)`, but leaves trivial elements uninitialized (e.g. for I/O buffers)
+template <typename T, typename = std::enable_if_t<std::is_unbounded_array_v<T>>>
+SharedPtr<T> MakeSharedForOverwrite(size_t size) {
+    return SharedPtr<T>(ArrayAllocateBlock<std::remove_extent_t<T>>::CreateForOverwrite(size));
 };
 
 template <typename T>
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "shared.h"
+#include <array>
+#include <cstddef>  // size_t
+#include <memory>   // std::destroy_at
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Control Block for objects that live and die together.
+// All members are constructed in place right inside the block, in declaration order,
+// and destroyed in reverse order when the last `SharedPtr` to any of them dies.
+template <typename... Ts>
+class GroupAllocateBlock : public IBlock {
+private:
+    template <size_t I>
+    using Member = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+    // Offset of every member inside `bytes_` followed by the total size
+    static constexpr std::array<size_t, sizeof...(Ts) + 1> Layout() {
+        size_t sizes[] = {sizeof(Ts)...};
+        size_t alignments[] = {alignof(Ts)...};
+        std::array<size_t, sizeof...(Ts) + 1> offsets{};
+        size_t offset = 0;
+        for (size_t i = 0; i < sizeof...(Ts); ++i) {
+            offset = (offset + alignments[i] - 1) / alignments[i] * alignments[i];
+            offsets[i] = offset;
+            offset += sizes[i];
+        }
+        offsets[sizeof...(Ts)] = offset;
+        return offsets;
+    }
+
+    static constexpr std::array<size_t, sizeof...(Ts) + 1> kLayout = Layout();
+
+    void Deleter() override {
+        DestroyFirst(std::index_sequence_for<Ts...>{}, sizeof...(Ts));
+    }
+
+    // Destroys members [0, count) in reverse order
+    template <size_t... Is>
+    void DestroyFirst(std::index_sequence<Is...>, size_t count) {
+        constexpr size_t kLast = sizeof...(Ts) - 1;
+        ((kLast - Is < count ? std::destroy_at(Get<kLast - Is>()) : void()), ...);
+    }
+
+    template <size_t I, typename Args>
+    void Construct(Args&& args) {
+        std::apply(
+            [this](auto&&... values) {
+                new (bytes_ + kLayout[I]) Member<I>(std::forward<decltype(values)>(values)...);
+            },
+            std::forward<Args>(args));
+    }
+
+    template <size_t... Is, typename... Args>
+    void ConstructAll(std::index_sequence<Is...>, Args&&... args) {
+        size_t constructed = 0;
+        try {
+            ((Construct<Is>(std::forward<Args>(args)), ++constructed), ...);
+        } catch (...) {
+            DestroyFirst(std::index_sequence_for<Ts...>{}, constructed);
+            throw;
+        }
+    }
+
+public:
+    // One tuple of constructor arguments per member
+    template <typename... Args>
+    explicit GroupAllocateBlock(Args&&... args) : IBlock() {
+        static_assert(sizeof...(Args) == sizeof...(Ts));
+        ConstructAll(std::index_sequence_for<Ts...>{}, std::forward<Args>(args)...);
+    }
+
+    template <size_t I>
+    Member<I>* Get() {
+        return std::launder(reinterpret_cast<Member<I>*>(bytes_ + kLayout[I]));
+    }
+
+private:
+    alignas(Ts...) char bytes_[kLayout[sizeof...(Ts)]];
+};
+
+template <typename T>
+using NoArgs = std::tuple<>;
+
+template <typename... Ts, typename... Args, size_t... Is>
+std::tuple<SharedPtr<Ts>...> MakeSharedGroupImpl(std::index_sequence<Is...>, Args&&... args) {
+    auto* block = new GroupAllocateBlock<Ts...>(std::forward<Args>(args)...);
+    using First = std::tuple_element_t<0, std::tuple<Ts...>>;
+    SharedPtr<First> owner(static_cast<IBlock*>(block), block->template Get<0>());
+    return {SharedPtr<Ts>(owner, block->template Get<Is>())...};
+}
+
+// Constructs all `Ts...` in one allocation under one control block and returns aliasing
+// pointers to each of them. Every argument is a tuple of constructor arguments for the
+// corresponding member (`std::forward_as_tuple(...)`, `std::tuple<>()` for default);
+// without arguments all members are default-constructed.
+// `EnableSharedFromThis` is not supported for group members.
+template <typename... Ts, typename... Args>
+std::tuple<SharedPtr<Ts>...> MakeSharedGroup(Args&&... args) {
+    static_assert(sizeof...(Ts) > 0);
+    static_assert(sizeof...(Args) == 0 || sizeof...(Args) == sizeof...(Ts),
+                  "Expected one tuple of constructor arguments per member");
+    if constexpr (sizeof...(Args) == 0) {
+        return MakeSharedGroupImpl<Ts...>(std::index_sequence_for<Ts...>{}, NoArgs<Ts>{}...);
+    } else {
+        return MakeSharedGroupImpl<Ts...>(std::index_sequence_for<Ts...>{},
+                                          std::forward<Args>(args)...);
+    }
+}
+
+// Constructs `size` objects from the same `args...` in one allocation and returns
+// an aliasing pointer to each of them
+template <typename T, typename... Args>
+std::vector<SharedPtr<T>> MakeSharedBatch(size_t size, const Args&... args) {
+    SharedPtr<T[]> batch(ArrayAllocateBlock<T>::Emplace(size, args...));
+    std::vector<SharedPtr<T>> result;
+    result.reserve(size);
+    for (size_t i = 0; i < size; ++i) {
+        result.emplace_back(batch, batch.Get() + i);
+    }
+    return result;
+}
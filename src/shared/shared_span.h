@@ -0,0 +1,158 @@
+#pragma once
+
+#include "shared.h"
+#include <cassert>
+#include <cstddef>  // std::byte
+#include <cstring>  // std::memcpy
+#include <span>
+#include <type_traits>
+
+// Refcounted view of a contiguous range inside a shared buffer.
+// Every slice aliases the control block of the buffer (see `SharedPtr` aliasing constructor),
+// so slicing is O(1), copies no data and keeps the whole buffer alive.
+template <typename T>
+class SharedSpan {
+private:
+    template <typename Y>
+    friend class SharedSpan;
+
+public:
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    SharedSpan() = default;
+
+    // Views the first `size` elements of `array`
+    template <typename Y, typename = std::enable_if_t<std::is_convertible_v<Y (*)[], T (*)[]>>>
+    SharedSpan(const SharedPtr<Y[]>& array, size_t size) : data_{array, array.Get()}, size_{size} {
+    }
+
+    // `SharedSpan<T>` -> `SharedSpan<const T>`
+    template <typename Y, typename = std::enable_if_t<std::is_convertible_v<Y (*)[], T (*)[]>>>
+    SharedSpan(const SharedSpan<Y>& other) : data_{other.data_}, size_{other.size_} {
+    }
+
+    template <typename Y, typename = std::enable_if_t<std::is_convertible_v<Y (*)[], T (*)[]>>>
+    SharedSpan(SharedSpan<Y>&& other)
+        : data_{std::move(other.data_)}, size_{std::exchange(other.size_, 0)} {
+    }
+
+    SharedSpan(const SharedSpan&) = default;
+
+    SharedSpan(SharedSpan&& other) : data_{std::move(other.data_)}, size_{other.size_} {
+        other.size_ = 0;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // `operator=`-s
+
+    SharedSpan& operator=(const SharedSpan&) = default;
+
+    SharedSpan& operator=(SharedSpan&& other) {
+        data_ = std::move(other.data_);
+        size_ = std::exchange(other.size_, 0);
+        return *this;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Slicing
+
+    SharedSpan Subspan(size_t offset, size_t count) const {
+        assert(offset <= size_ && count <= size_ - offset);
+        return SharedSpan(SharedPtr<T>(data_, data_.Get() + offset), count);
+    }
+
+    SharedSpan Subspan(size_t offset) const {
+        assert(offset <= size_);
+        return Subspan(offset, size_ - offset);
+    }
+
+    SharedSpan First(size_t count) const {
+        return Subspan(0, count);
+    }
+
+    SharedSpan Last(size_t count) const {
+        assert(count <= size_);
+        return Subspan(size_ - count, count);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+
+    void Reset() {
+        data_.Reset();
+        size_ = 0;
+    }
+
+    void Swap(SharedSpan& other) {
+        data_.Swap(other.data_);
+        std::swap(size_, other.size_);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    T* Data() const {
+        return data_.Get();
+    }
+
+    size_t Size() const {
+        return size_;
+    }
+
+    bool Empty() const {
+        return size_ == 0;
+    }
+
+    T& operator[](size_t i) const {
+        assert(i < size_);
+        return data_.Get()[i];
+    }
+
+    T* begin() const {
+        return Data();
+    }
+
+    T* end() const {
+        return Data() + size_;
+    }
+
+    std::span<T> Span() const {
+        return {Data(), size_};
+    }
+
+    // Number of owners of the underlying buffer
+    size_t UseCount() const {
+        return data_.UseCount();
+    }
+
+private:
+    SharedSpan(SharedPtr<T>&& data, size_t size) : data_{std::move(data)}, size_{size} {
+    }
+
+    SharedPtr<T> data_;
+    size_t size_ = 0;
+};
+
+using SharedBytes = SharedSpan<const std::byte>;
+
+// Allocates a buffer of `size` value-initialized elements with a single allocation
+template <typename T>
+SharedSpan<T> MakeSharedSpan(size_t size) {
+    return SharedSpan<T>(MakeShared<T[]>(size), size);
+}
+
+// Like `MakeSharedSpan`, but leaves trivial elements uninitialized for the caller to overwrite
+template <typename T>
+SharedSpan<T> MakeSharedSpanForOverwrite(size_t size) {
+    return SharedSpan<T>(MakeSharedForOverwrite<T[]>(size), size);
+}
+
+// Copies `bytes` into a new shared buffer
+inline SharedBytes MakeSharedBytes(std::span<const std::byte> bytes) {
+    SharedPtr<std::byte[]> buffer = MakeSharedForOverwrite<std::byte[]>(bytes.size());
+    if (!bytes.empty()) {
+        std::memcpy(buffer.Get(), bytes.data(), bytes.size());
+    }
+    return SharedSpan<std::byte>(buffer, bytes.size());
+}
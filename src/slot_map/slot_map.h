@@ -0,0 +1,196 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>  // std::length_error
+#include <utility>
+#include <vector>
+
+// Generation-checked reference to an element of `SlotMap<T>`.
+// Unlike `WeakPtr` it is 8 bytes, needs no control block and is trivially copyable.
+template <typename T>
+struct SlotHandle {
+    static constexpr uint32_t kNullIndex = std::numeric_limits<uint32_t>::max();
+
+    uint32_t index = kNullIndex;
+    // Generations start at 1, so a default handle never matches a slot
+    uint32_t generation = 0;
+
+    explicit operator bool() const {
+        return index != kNullIndex;
+    }
+
+    friend bool operator==(const SlotHandle&, const SlotHandle&) = default;
+};
+
+// Container that keeps its elements contiguous and hands out `SlotHandle`s to them.
+// Lookup and expiry checks are O(1): a handle points to a slot, the slot stores the element
+// position and the current generation. Erasing moves the last element into the hole, so the
+// elements stay packed and every other handle remains valid.
+template <typename T>
+class SlotMap {
+private:
+    struct Slot {
+        // Position in `values_` while occupied, next free slot otherwise
+        uint32_t dense_or_next;
+        uint32_t generation;
+    };
+
+public:
+    using Handle = SlotHandle<T>;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+
+    template <typename... Args>
+    Handle Emplace(Args&&... args) {
+        // Every step that may throw leaves the map consistent
+        if (free_head_ == Handle::kNullIndex) {
+            if (slots_.size() == Handle::kNullIndex) {
+                throw std::length_error("SlotMap is full");
+            }
+            slots_.push_back(Slot{Handle::kNullIndex, 1});
+            free_head_ = slots_.size() - 1;
+        }
+        uint32_t index = free_head_;
+        dense_to_slot_.push_back(index);
+        try {
+            values_.emplace_back(std::forward<Args>(args)...);
+        } catch (...) {
+            dense_to_slot_.pop_back();
+            throw;
+        }
+
+        free_head_ = slots_[index].dense_or_next;
+        slots_[index].dense_or_next = values_.size() - 1;
+        return Handle{index, slots_[index].generation};
+    }
+
+    Handle Insert(T value) {
+        return Emplace(std::move(value));
+    }
+
+    // Returns false if the handle has already expired
+    bool Erase(Handle handle) {
+        if (!Contains(handle)) {
+            return false;
+        }
+        Slot& slot = slots_[handle.index];
+        uint32_t dense = slot.dense_or_next;
+        uint32_t last = values_.size() - 1;
+        if (dense != last) {
+            values_[dense] = std::move(values_[last]);
+            dense_to_slot_[dense] = dense_to_slot_[last];
+            slots_[dense_to_slot_[dense]].dense_or_next = dense;
+        }
+        values_.pop_back();
+        dense_to_slot_.pop_back();
+        FreeSlot(handle.index);
+        return true;
+    }
+
+    // Invalidates all handles
+    void Clear() {
+        for (uint32_t index : dense_to_slot_) {
+            FreeSlot(index);
+        }
+        values_.clear();
+        dense_to_slot_.clear();
+    }
+
+    void Reserve(size_t size) {
+        values_.reserve(size);
+        dense_to_slot_.reserve(size);
+        slots_.reserve(size);
+    }
+
+    // Returns unused capacity of the element storage to the allocator.
+    // Slots are never removed: they carry the generations that keep old handles expired.
+    void ShrinkToFit() {
+        values_.shrink_to_fit();
+        dense_to_slot_.shrink_to_fit();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    bool Contains(Handle handle) const {
+        return handle.index < slots_.size() && slots_[handle.index].generation == handle.generation;
+    }
+
+    // `nullptr` if the handle has expired
+    T* Get(Handle handle) {
+        return Contains(handle) ? &values_[slots_[handle.index].dense_or_next] : nullptr;
+    }
+
+    const T* Get(Handle handle) const {
+        return Contains(handle) ? &values_[slots_[handle.index].dense_or_next] : nullptr;
+    }
+
+    T& operator[](Handle handle) {
+        assert(Contains(handle));
+        return values_[slots_[handle.index].dense_or_next];
+    }
+
+    const T& operator[](Handle handle) const {
+        assert(Contains(handle));
+        return values_[slots_[handle.index].dense_or_next];
+    }
+
+    // Handle of the element at position `i` of the contiguous storage
+    Handle HandleAt(size_t i) const {
+        uint32_t index = dense_to_slot_[i];
+        return Handle{index, slots_[index].generation};
+    }
+
+    size_t Size() const {
+        return values_.size();
+    }
+
+    bool Empty() const {
+        return values_.empty();
+    }
+
+    // Elements in storage order, which changes on `Erase`
+    std::span<T> Values() {
+        return values_;
+    }
+
+    std::span<const T> Values() const {
+        return values_;
+    }
+
+    auto begin() {
+        return values_.begin();
+    }
+
+    auto end() {
+        return values_.end();
+    }
+
+    auto begin() const {
+        return values_.begin();
+    }
+
+    auto end() const {
+        return values_.end();
+    }
+
+private:
+    void FreeSlot(uint32_t index) {
+        Slot& slot = slots_[index];
+        // A slot whose generation wraps around is retired, so stale handles never match again
+        if (++slot.generation == 0) {
+            return;
+        }
+        slot.dense_or_next = free_head_;
+        free_head_ = index;
+    }
+
+    std::vector<T> values_;
+    std::vector<uint32_t> dense_to_slot_;
+    std::vector<Slot> slots_;
+    uint32_t free_head_ = Handle::kNullIndex;
+};
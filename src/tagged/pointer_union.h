@@ -0,0 +1,106 @@
+#pragma once
+
+#include "tagged_ptr.h"
+#include <type_traits>
+
+// Index of `P` in `Ps...`, `sizeof...(Ps)` if it is not there
+template <typename P, typename... Ps>
+constexpr size_t PointerUnionIndex() {
+    constexpr bool kMatches[] = {std::is_same_v<P, Ps>...};
+    for (size_t i = 0; i < sizeof...(Ps); ++i) {
+        if (kMatches[i]) {
+            return i;
+        }
+    }
+    return sizeof...(Ps);
+}
+
+// Pointer to one of `Ps...` (e.g. `PointerUnion<Leaf*, Branch*>`) in a single word.
+// The alternative is stored in the alignment bits, so every pointee needs enough of them.
+template <typename... Ps>
+class PointerUnion {
+    static_assert((std::is_pointer_v<Ps> && ...), "PointerUnion holds pointers");
+
+private:
+    static constexpr size_t kBits = sizeof...(Ps) <= 2 ? 1 : sizeof...(Ps) <= 4 ? 2 : 3;
+    static_assert(sizeof...(Ps) <= 8, "Too many alternatives");
+
+    template <typename P>
+    static constexpr size_t kIndex = PointerUnionIndex<P, Ps...>();
+
+    template <typename P>
+    using IfAlternative = std::enable_if_t<kIndex<P> < sizeof...(Ps)>;
+
+public:
+    // Constructors
+    PointerUnion() = default;
+
+    PointerUnion(std::nullptr_t) {
+    }
+
+    template <typename P, typename = IfAlternative<P>>
+    PointerUnion(P ptr) : data_{ptr, kIndex<P>} {
+    }
+
+    // Observers
+    // Index of the current alternative in `Ps...`
+    size_t Index() const {
+        return data_.GetTag();
+    }
+
+    template <typename P, typename = IfAlternative<P>>
+    bool Is() const {
+        return Index() == kIndex<P>;
+    }
+
+    template <typename P, typename = IfAlternative<P>>
+    P Get() const {
+        assert(Is<P>());
+        return static_cast<P>(data_.Get());
+    }
+
+    // `nullptr` if another alternative is stored
+    template <typename P, typename = IfAlternative<P>>
+    P DynCast() const {
+        return Is<P>() ? static_cast<P>(data_.Get()) : nullptr;
+    }
+
+    explicit operator bool() const {
+        return static_cast<bool>(data_);
+    }
+
+    friend bool operator==(const PointerUnion&, const PointerUnion&) = default;
+
+private:
+    // The stored alternative is checked to have `kBits` free bits in `TaggedPtr`'s constructor
+    class Erased {
+    public:
+        Erased() = default;
+
+        template <typename P>
+        Erased(P ptr, size_t index)
+            : bits_{TaggedPtr<std::remove_pointer_t<P>, kBits>(ptr, index).Raw()} {
+        }
+
+        void* Get() const {
+            return reinterpret_cast<void*>(bits_ & ~kTagMask);
+        }
+
+        uintptr_t GetTag() const {
+            return bits_ & kTagMask;
+        }
+
+        explicit operator bool() const {
+            return (bits_ & ~kTagMask) != 0;
+        }
+
+        friend bool operator==(const Erased&, const Erased&) = default;
+
+    private:
+        static constexpr uintptr_t kTagMask = (uintptr_t{1} << kBits) - 1;
+
+        uintptr_t bits_ = 0;
+    };
+
+    Erased data_;
+};
@@ -0,0 +1,287 @@
+#pragma once
+
+#include "../unique/compressed_pair.h"
+#include "../unique/unique.h"
+#include <cassert>
+#include <cstddef>  // std::nullptr_t
+#include <cstdint>  // uintptr_t
+#include <utility>
+
+// Number of low pointer bits that are always zero for `T*`
+template <typename T>
+constexpr size_t FreeLowBits() {
+    size_t bits = 0;
+    while ((size_t{1} << (bits + 1)) <= alignof(T)) {
+        ++bits;
+    }
+    return bits;
+}
+
+// Non-owning `T*` with a `Bits`-wide tag stored in its alignment bits.
+// Alignment is checked where the pointer is used, so `T` may be incomplete at declaration
+// (e.g. a tagged child pointer inside a tree node).
+template <typename T, size_t Bits>
+class TaggedPtr {
+public:
+    static constexpr uintptr_t kTagMask = (uintptr_t{1} << Bits) - 1;
+
+    // Constructors
+    constexpr TaggedPtr() = default;
+
+    constexpr TaggedPtr(std::nullptr_t) {
+    }
+
+    TaggedPtr(T* ptr, uintptr_t tag = 0) {
+        CheckAlignment();
+        assert((tag & ~kTagMask) == 0);
+        bits_ = reinterpret_cast<uintptr_t>(ptr) | tag;
+    }
+
+    // Modifiers
+    void SetPointer(T* ptr) {
+        *this = TaggedPtr(ptr, GetTag());
+    }
+
+    void SetTag(uintptr_t tag) {
+        assert((tag & ~kTagMask) == 0);
+        bits_ = (bits_ & ~kTagMask) | tag;
+    }
+
+    // Observers
+    T* Get() const {
+        CheckAlignment();
+        return reinterpret_cast<T*>(bits_ & ~kTagMask);
+    }
+
+    uintptr_t GetTag() const {
+        return bits_ & kTagMask;
+    }
+
+    T& operator*() const {
+        return *Get();
+    }
+
+    T* operator->() const {
+        return Get();
+    }
+
+    explicit operator bool() const {
+        return (bits_ & ~kTagMask) != 0;
+    }
+
+    // Pointer and tag packed together
+    uintptr_t Raw() const {
+        return bits_;
+    }
+
+    friend bool operator==(const TaggedPtr&, const TaggedPtr&) = default;
+
+private:
+    static void CheckAlignment() {
+        static_assert(Bits <= FreeLowBits<T>(), "Alignment of T leaves fewer free bits");
+    }
+
+    uintptr_t bits_ = 0;
+};
+
+// `IntrusivePtr` with tag bits. The tag is independent state: copies carry it along,
+// resetting the pointer keeps it.
+template <typename T, size_t Bits>
+class TaggedIntrusivePtr {
+public:
+    // Constructors
+    TaggedIntrusivePtr() = default;
+
+    TaggedIntrusivePtr(std::nullptr_t) {
+    }
+
+    TaggedIntrusivePtr(T* ptr, uintptr_t tag = 0) : data_{ptr, tag} {
+        if (ptr != nullptr) {
+            ptr->IncRef();
+        }
+    }
+
+    TaggedIntrusivePtr(const TaggedIntrusivePtr& other) : data_{other.data_} {
+        if (T* ptr = Get()) {
+            ptr->IncRef();
+        }
+    }
+
+    TaggedIntrusivePtr(TaggedIntrusivePtr&& other) : data_{std::exchange(other.data_, {})} {
+    }
+
+    // `operator=`-s
+    TaggedIntrusivePtr& operator=(const TaggedIntrusivePtr& other) {
+        if (data_ != other.data_) {
+            TaggedIntrusivePtr(other).Swap(*this);
+        }
+        return *this;
+    }
+
+    TaggedIntrusivePtr& operator=(TaggedIntrusivePtr&& other) {
+        if (this != &other) {
+            TaggedIntrusivePtr(std::move(other)).Swap(*this);
+        }
+        return *this;
+    }
+
+    // Destructor
+    ~TaggedIntrusivePtr() {
+        Reset();
+    }
+
+    // Modifiers
+    void Reset() {
+        if (T* ptr = Get()) {
+            data_.SetPointer(nullptr);
+            ptr->DecRef();
+        }
+    }
+
+    void Reset(T* ptr) {
+        TaggedIntrusivePtr(ptr, GetTag()).Swap(*this);
+    }
+
+    void SetTag(uintptr_t tag) {
+        data_.SetTag(tag);
+    }
+
+    void Swap(TaggedIntrusivePtr& other) {
+        std::swap(data_, other.data_);
+    }
+
+    // Observers
+    T* Get() const {
+        return data_.Get();
+    }
+
+    uintptr_t GetTag() const {
+        return data_.GetTag();
+    }
+
+    T& operator*() const {
+        return *Get();
+    }
+
+    T* operator->() const {
+        return Get();
+    }
+
+    size_t UseCount() const {
+        T* ptr = Get();
+        return ptr == nullptr ? 0 : ptr->RefCount();
+    }
+
+    explicit operator bool() const {
+        return static_cast<bool>(data_);
+    }
+
+private:
+    TaggedPtr<T, Bits> data_;
+};
+
+// `UniquePtr` with tag bits, stateless deleters take no extra space
+template <typename T, size_t Bits, typename Deleter = Slug<T>>
+class TaggedUniquePtr {
+public:
+    // Constructors
+    TaggedUniquePtr() = default;
+
+    TaggedUniquePtr(std::nullptr_t) {
+    }
+
+    explicit TaggedUniquePtr(T* ptr, uintptr_t tag = 0)
+        : data_{TaggedPtr<T, Bits>(ptr, tag), Deleter()} {
+    }
+
+    TaggedUniquePtr(T* ptr, uintptr_t tag, Deleter deleter)
+        : data_{TaggedPtr<T, Bits>(ptr, tag), std::forward<Deleter>(deleter)} {
+    }
+
+    TaggedUniquePtr(const TaggedUniquePtr&) = delete;
+
+    TaggedUniquePtr(TaggedUniquePtr&& other)
+        : data_{TaggedPtr<T, Bits>(other.Release(), other.GetTag()),
+                std::move(other.GetDeleter())} {
+    }
+
+    // `operator=`-s
+    TaggedUniquePtr& operator=(const TaggedUniquePtr&) = delete;
+
+    TaggedUniquePtr& operator=(TaggedUniquePtr&& other) {
+        if (this != &other) {
+            uintptr_t tag = other.GetTag();
+            Reset(other.Release());
+            SetTag(tag);
+            GetDeleter() = std::move(other.GetDeleter());
+        }
+        return *this;
+    }
+
+    TaggedUniquePtr& operator=(std::nullptr_t) {
+        Reset();
+        return *this;
+    }
+
+    // Destructor
+    ~TaggedUniquePtr() {
+        Reset();
+    }
+
+    // Modifiers
+    // Returns the pointer, the tag stays
+    T* Release() {
+        T* ptr = Get();
+        data_.GetFirst().SetPointer(nullptr);
+        return ptr;
+    }
+
+    void Reset(T* ptr = nullptr) {
+        T* old = Get();
+        data_.GetFirst().SetPointer(ptr);
+        if (old != nullptr) {
+            GetDeleter()(old);
+        }
+    }
+
+    void SetTag(uintptr_t tag) {
+        data_.GetFirst().SetTag(tag);
+    }
+
+    void Swap(TaggedUniquePtr& other) {
+        std::swap(data_.GetFirst(), other.data_.GetFirst());
+        std::swap(data_.GetSecond(), other.data_.GetSecond());
+    }
+
+    // Observers
+    T* Get() const {
+        return data_.GetFirst().Get();
+    }
+
+    uintptr_t GetTag() const {
+        return data_.GetFirst().GetTag();
+    }
+
+    Deleter& GetDeleter() {
+        return data_.GetSecond();
+    }
+
+    const Deleter& GetDeleter() const {
+        return data_.GetSecond();
+    }
+
+    T& operator*() const {
+        return *Get();
+    }
+
+    T* operator->() const {
+        return Get();
+    }
+
+    explicit operator bool() const {
+        return static_cast<bool>(data_.GetFirst());
+    }
+
+private:
+    CompressedPair<TaggedPtr<T, Bits>, Deleter> data_;
+};
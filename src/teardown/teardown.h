@@ -0,0 +1,139 @@
+#pragma once
+
+#include "../shared/shared.h"
+#include "../unique/unique.h"
+#include <algorithm>  // std::min, std::max
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Trampoline that turns recursive destruction of linked structures into a loop.
+// While one object is being deleted, objects released by its destructor are queued instead of
+// deleted in place, so tearing down a list of any length takes O(1) stack, and a tree takes
+// memory proportional to its width instead of stack proportional to its depth.
+class TeardownQueue {
+private:
+    struct Pending {
+        void* ptr;
+        void (*destroy)(void*);
+    };
+
+public:
+    TeardownQueue() = default;
+
+    TeardownQueue(const TeardownQueue&) = delete;
+    TeardownQueue& operator=(const TeardownQueue&) = delete;
+
+    // Queue of the current thread
+    static TeardownQueue& Local() {
+        thread_local TeardownQueue queue;
+        return queue;
+    }
+
+    template <typename T>
+    void Delete(T* ptr) {
+        if (draining_) {
+            pending_.push_back({const_cast<void*>(static_cast<const void*>(ptr)), &Destroy<T>});
+            return;
+        }
+
+        draining_ = true;
+        delete ptr;
+        while (!pending_.empty()) {
+            Pending next = pending_.back();
+            pending_.pop_back();
+            next.destroy(next.ptr);
+        }
+        draining_ = false;
+    }
+
+    // Objects waiting for deletion, non-zero only inside a destructor
+    size_t PendingCount() const {
+        return pending_.size();
+    }
+
+private:
+    template <typename T>
+    static void Destroy(void* ptr) {
+        delete static_cast<T*>(ptr);
+    }
+
+    std::vector<Pending> pending_;
+    bool draining_ = false;
+};
+
+// Deleter policy for `RefCounted` nodes of long chains and deep trees
+struct IterativeDelete {
+    template <typename T>
+    static void Destroy(T* object) {
+        TeardownQueue::Local().Delete(object);
+    }
+};
+
+// Deleter for `UniquePtr<T, IterativeDeleter<T>>` and `SharedPtr<T>(ptr, IterativeDeleter<T>())`
+template <typename T>
+struct IterativeDeleter {
+    IterativeDeleter() = default;
+
+    template <typename U>
+    IterativeDeleter(IterativeDeleter<U>&&) {
+    }
+
+    template <typename U>
+    IterativeDeleter& operator=(IterativeDeleter<U>&&) {
+        return *this;
+    }
+
+    void operator()(T* ptr) const {
+        TeardownQueue::Local().Delete(ptr);
+    }
+};
+
+template <typename T>
+using IterativeUniquePtr = UniquePtr<T, IterativeDeleter<T>>;
+
+template <typename T, typename... Args>
+IterativeUniquePtr<T> MakeUniqueIterative(Args&&... args) {
+    return IterativeUniquePtr<T>(new T(std::forward<Args>(args)...));
+}
+
+// The object is not co-allocated with the control block: `MakeShared` blocks destroy it in
+// place, which cannot be deferred.
+template <typename T, typename... Args>
+SharedPtr<T> MakeSharedIterative(Args&&... args) {
+    return SharedPtr<T>(new T(std::forward<Args>(args)...), IterativeDeleter<T>());
+}
+
+// Releases `owners` on up to `threads` threads, never more than the hardware runs at once.
+// Reference counts are not atomic, so the structures must not share nodes with each other or with
+// anything outside of `owners`, e.g. the subtrees of a tree whose root has already been detached.
+// Every call starts and joins `threads - 1` threads (tens of microseconds each), so it pays off
+// only for structures that take far longer than that to free, e.g. once at shutdown, and is not
+// meant for hot paths.
+template <typename Ptr>
+void DestroyInParallel(std::vector<Ptr>&& owners,
+                       size_t threads = std::thread::hardware_concurrency()) {
+    size_t hardware = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    threads = std::min({std::max<size_t>(threads, 1), hardware, owners.size()});
+    if (threads <= 1) {
+        owners.clear();
+        return;
+    }
+
+    std::atomic<size_t> next = 0;
+    auto worker = [&owners, &next] {
+        for (size_t i = next++; i < owners.size(); i = next++) {
+            owners[i].Reset();
+        }
+    };
+    std::vector<std::thread> pool;
+    for (size_t i = 1; i < threads; ++i) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+    owners.clear();
+}
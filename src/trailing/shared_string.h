@@ -0,0 +1,87 @@
+#pragma once
+
+#include "trailing.h"
+#include <compare>
+#include <cstring>  // std::memcpy
+#include <string_view>
+
+// Immutable refcounted string. Header, characters and the control block share one allocation,
+// copies only bump the counter, and `CStr()` is always null-terminated.
+class SharedString {
+private:
+    // Characters follow the header, the last trailing `char` is the terminating zero
+    struct Data : WithTrailing<Data, char> {};
+
+public:
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    SharedString() = default;
+
+    SharedString(std::string_view str) {
+        if (str.empty()) {
+            return;
+        }
+        SharedPtr<Data> data = MakeSharedWithTrailing<Data>(str.size() + 1);
+        // Trailing elements are value-initialized, so the terminator is already in place
+        std::memcpy(data->Trailing().data(), str.data(), str.size());
+        data_ = std::move(data);
+    }
+
+    SharedString(const char* str) : SharedString(std::string_view(str)) {
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+
+    void Reset() {
+        data_.Reset();
+    }
+
+    void Swap(SharedString& other) {
+        data_.Swap(other.data_);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    std::string_view View() const {
+        if (!data_) {
+            return {};
+        }
+        std::span chars = data_->Trailing();
+        return {chars.data(), chars.size() - 1};
+    }
+
+    operator std::string_view() const {
+        return View();
+    }
+
+    const char* CStr() const {
+        return data_ ? data_->Trailing().data() : "";
+    }
+
+    size_t Size() const {
+        return View().size();
+    }
+
+    bool Empty() const {
+        return !data_;
+    }
+
+    // Number of strings sharing the characters
+    size_t UseCount() const {
+        return data_.UseCount();
+    }
+
+    friend bool operator==(const SharedString& lhs, const SharedString& rhs) {
+        return lhs.data_.Get() == rhs.data_.Get() || lhs.View() == rhs.View();
+    }
+
+    friend std::strong_ordering operator<=>(const SharedString& lhs, const SharedString& rhs) {
+        return lhs.View() <=> rhs.View();
+    }
+
+private:
+    SharedPtr<const Data> data_;
+};
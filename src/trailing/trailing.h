@@ -0,0 +1,162 @@
+#pragma once
+
+#include "../intrusive/intrusive.h"
+#include "../shared/shared.h"
+#include <cstddef>  // size_t
+#include <memory>   // std::destroy, std::uninitialized_value_construct_n
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>  // std::declval
+
+// Mixin for objects followed by a variable number of `E`s in the same allocation.
+// Such objects are created only by `MakeSharedWithTrailing` or `MakeIntrusiveWithTrailing`;
+// the trailing elements are value-initialized and visible through `Trailing()` after the
+// constructor of `Derived` has finished.
+template <typename Derived, typename E>
+class WithTrailing {
+public:
+    using TrailingType = E;
+
+    // Distance between the object and its first trailing element
+    static constexpr size_t TrailingOffset() {
+        return (sizeof(Derived) + alignof(E) - 1) / alignof(E) * alignof(E);
+    }
+
+    std::span<E> Trailing() {
+        auto* self = reinterpret_cast<char*>(static_cast<Derived*>(this));
+        return {std::launder(reinterpret_cast<E*>(self + TrailingOffset())), trailing_size_};
+    }
+
+    std::span<const E> Trailing() const {
+        auto* self = reinterpret_cast<const char*>(static_cast<const Derived*>(this));
+        return {std::launder(reinterpret_cast<const E*>(self + TrailingOffset())),
+                trailing_size_};
+    }
+
+private:
+    friend struct TrailingAccess;
+
+    size_t trailing_size_ = 0;
+};
+
+// Constructs a `WithTrailing` object at `where` with `size` trailing elements after it
+struct TrailingAccess {
+    template <typename T, typename... Args>
+    static T* Construct(void* where, size_t size, Args&&... args) {
+        using E = typename T::TrailingType;
+        static_assert(std::is_base_of_v<WithTrailing<T, E>, T>);
+
+        auto* trailing = reinterpret_cast<E*>(static_cast<char*>(where) + T::TrailingOffset());
+        std::uninitialized_value_construct_n(trailing, size);
+        T* object = nullptr;
+        try {
+            object = new (where) T(std::forward<Args>(args)...);
+        } catch (...) {
+            std::destroy_n(trailing, size);
+            throw;
+        }
+        static_cast<WithTrailing<T, E>*>(object)->trailing_size_ = size;
+        return object;
+    }
+
+    template <typename T>
+    static void Destroy(T* object) {
+        std::span trailing = object->Trailing();
+        std::destroy(trailing.begin(), trailing.end());
+        object->~T();
+    }
+
+    // Bytes for the object and `size` trailing elements
+    template <typename T>
+    static constexpr size_t AllocationSize(size_t size) {
+        return T::TrailingOffset() + size * sizeof(typename T::TrailingType);
+    }
+};
+
+// Control Block for make_shared_with_trailing<T>(size, Args&&...)
+// The object lives inside the block and its trailing elements follow the block.
+template <typename T>
+class TrailingAllocateBlock : public IBlock {
+private:
+    void Deleter() override {
+        TrailingAccess::Destroy(ptr_);
+    }
+
+    void Destroy() override {
+        this->~TrailingAllocateBlock();
+        ::operator delete(static_cast<void*>(this));
+    }
+
+    TrailingAllocateBlock() : IBlock() {
+    }
+
+public:
+    T* ptr_ = nullptr;
+    alignas(T) char bytes_[sizeof(T)];
+
+    template <typename... Args>
+    static TrailingAllocateBlock* Create(size_t size, Args&&... args) {
+        static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__ &&
+                      alignof(typename T::TrailingType) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+        // `bytes_` ends inside the block, so the trailing elements end before this bound
+        size_t bytes = sizeof(TrailingAllocateBlock) - sizeof(T) +
+                       TrailingAccess::AllocationSize<T>(size);
+        void* raw = ::operator new(bytes);
+        auto* block = new (raw) TrailingAllocateBlock();
+        try {
+            block->ptr_ = TrailingAccess::Construct<T>(block->bytes_, size,
+                                                       std::forward<Args>(args)...);
+        } catch (...) {
+            block->~TrailingAllocateBlock();
+            ::operator delete(raw);
+            throw;
+        }
+        return block;
+    }
+};
+
+// `MakeShared` for `T : WithTrailing<T, E>` with `size` trailing `E`s in the same allocation
+template <typename T, typename... Args>
+SharedPtr<T> MakeSharedWithTrailing(size_t size, Args&&... args) {
+    auto* block = TrailingAllocateBlock<T>::Create(size, std::forward<Args>(args)...);
+    return SharedPtr<T>(static_cast<IBlock*>(block), block->ptr_);
+}
+
+// Deleter policy for `RefCounted` objects created by `MakeIntrusiveWithTrailing`
+struct TrailingDelete {
+    template <typename T>
+    static void Destroy(T* object) {
+        TrailingAccess::Destroy(object);
+        ::operator delete(static_cast<void*>(object));
+    }
+};
+
+// True if `T` derives from `RefCounted<T, Counter, TrailingDelete>`
+template <typename T>
+struct UsesTrailingDelete {
+private:
+    template <typename Counter>
+    static std::true_type Check(const RefCounted<T, Counter, TrailingDelete>*);
+    static std::false_type Check(...);
+
+public:
+    static constexpr bool value = decltype(Check(std::declval<T*>()))::value;
+};
+
+// `MakeIntrusive` for `T : WithTrailing<T, E>`, `T` must be destroyed with `TrailingDelete`
+template <typename T, typename... Args>
+IntrusivePtr<T> MakeIntrusiveWithTrailing(size_t size, Args&&... args) {
+    // Any other policy would `delete` an object placed inside a raw, oversized allocation
+    static_assert(UsesTrailingDelete<T>::value, "T must be RefCounted with TrailingDelete");
+    static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__ &&
+                  alignof(typename T::TrailingType) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+    void* raw = ::operator new(TrailingAccess::AllocationSize<T>(size));
+    try {
+        T* object = TrailingAccess::Construct<T>(raw, size, std::forward<Args>(args)...);
+        return IntrusivePtr<T>(object);
+    } catch (...) {
+        ::operator delete(raw);
+        throw;
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>  // size_t
+#include <tuple>    // std::tuple_element_t
+#include <type_traits>
+#include <utility>
+
+// Generalization of `CompressedPair` for any number of members.
+// Every empty non-final member is stored as a base class, so it takes no space.
+// Each member is wrapped into its own indexed element, so repeated or related types do not clash.
+
+template <size_t I, typename T, bool = std::is_empty_v<T> && !std::is_final_v<T>>
+class CompressedTupleElement {
+public:
+    constexpr CompressedTupleElement() : value_{} {
+    }
+
+    template <typename U>
+    constexpr explicit CompressedTupleElement(U&& value) : value_(std::forward<U>(value)) {
+    }
+
+    constexpr T& Get() {
+        return value_;
+    }
+
+    constexpr const T& Get() const {
+        return value_;
+    }
+
+private:
+    T value_;
+};
+
+template <size_t I, typename T>
+class CompressedTupleElement<I, T, true> : private T {
+public:
+    constexpr CompressedTupleElement() = default;
+
+    template <typename U>
+    constexpr explicit CompressedTupleElement(U&& value) : T(std::forward<U>(value)) {
+    }
+
+    constexpr T& Get() {
+        return *this;
+    }
+
+    constexpr const T& Get() const {
+        return *this;
+    }
+};
+
+template <typename Indices, typename... Ts>
+class CompressedTupleBase;
+
+template <size_t... Is, typename... Ts>
+class CompressedTupleBase<std::index_sequence<Is...>, Ts...>
+    : public CompressedTupleElement<Is, Ts>... {
+public:
+    constexpr CompressedTupleBase() = default;
+
+    template <typename... Us>
+    constexpr explicit CompressedTupleBase(Us&&... values)
+        : CompressedTupleElement<Is, Ts>(std::forward<Us>(values))... {
+    }
+};
+
+// Forbids the forwarding constructor to hijack copies of a single-member tuple.
+template <typename Tuple, typename... Us>
+struct IsSameTuple : std::false_type {};
+
+template <typename Tuple, typename U>
+struct IsSameTuple<Tuple, U> : std::is_same<std::decay_t<U>, Tuple> {};
+
+template <typename... Ts>
+class CompressedTuple : private CompressedTupleBase<std::index_sequence_for<Ts...>, Ts...> {
+private:
+    using Base = CompressedTupleBase<std::index_sequence_for<Ts...>, Ts...>;
+
+    template <size_t I>
+    using Element = CompressedTupleElement<I, std::tuple_element_t<I, std::tuple<Ts...>>>;
+
+public:
+    constexpr CompressedTuple() = default;
+
+    template <typename... Us,
+              typename = std::enable_if_t<sizeof...(Us) == sizeof...(Ts) && (sizeof...(Ts) > 0) &&
+                                          !IsSameTuple<CompressedTuple, Us...>::value>>
+    constexpr CompressedTuple(Us&&... values) : Base(std::forward<Us>(values)...) {
+    }
+
+    template <size_t I>
+    constexpr auto& Get() {
+        return static_cast<Element<I>&>(*this).Get();
+    }
+
+    template <size_t I>
+    constexpr const auto& Get() const {
+        return static_cast<const Element<I>&>(*this).Get();
+    }
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "../shared/shared.h"
+#include "unique.h"
+#include <cassert>
+#include <cstddef>  // size_t
+#include <cstdint>  // uintptr_t
+#include <memory>   // std::destroy_n, std::uninitialized_value_construct_n
+#include <new>      // std::bad_alloc
+#include <sys/mman.h>
+#include <type_traits>
+
+// Size of a transparent huge page on x86-64 and aarch64 with 4 KiB base pages
+inline constexpr size_t kHugePageSize = 2 << 20;
+
+// `bytes` rounded up to whole huge pages
+inline size_t HugePagesLength(size_t bytes) {
+    return (bytes + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+}
+
+// Maps zeroed memory aligned to `alignment` (a power of two, at least `kHugePageSize`) and asks
+// the kernel to back it with huge pages.
+// When transparent huge pages are unavailable the region silently stays on normal pages.
+inline void* MapHugePages(size_t bytes, size_t alignment = kHugePageSize) {
+    assert(alignment >= kHugePageSize && (alignment & (alignment - 1)) == 0);
+    if (bytes == 0) {
+        return nullptr;
+    }
+
+    // Over-map by the alignment and cut the unaligned head and tail off
+    size_t length = HugePagesLength(bytes);
+    void* raw = mmap(nullptr, length + alignment, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+
+    auto begin = reinterpret_cast<uintptr_t>(raw);
+    auto aligned = (begin + alignment - 1) & ~(alignment - 1);
+    if (aligned != begin) {
+        munmap(raw, aligned - begin);
+    }
+    size_t tail = begin + alignment - aligned;
+    if (tail != 0) {
+        munmap(reinterpret_cast<void*>(aligned + length), tail);
+    }
+
+#ifdef MADV_HUGEPAGE
+    madvise(reinterpret_cast<void*>(aligned), length, MADV_HUGEPAGE);
+#endif
+    return reinterpret_cast<void*>(aligned);
+}
+
+inline void UnmapHugePages(void* ptr, size_t bytes) {
+    if (ptr != nullptr) {
+        munmap(ptr, HugePagesLength(bytes));
+    }
+}
+
+// Destroys `size` elements and unmaps the region allocated by `MapHugePages`
+template <typename T>
+class HugePageDeleter {
+public:
+    HugePageDeleter() = default;
+
+    explicit HugePageDeleter(size_t size) : size_(size) {
+    }
+
+    size_t Size() const {
+        return size_;
+    }
+
+    void operator()(T* ptr) const {
+        std::destroy_n(ptr, size_);
+        UnmapHugePages(const_cast<std::remove_cv_t<T>*>(ptr), size_ * sizeof(T));
+    }
+
+private:
+    size_t size_ = 0;
+};
+
+// Maps and value-initializes `size` elements. Fresh anonymous pages are already zeroed,
+// so trivial types are not touched and stay unfaulted until first use.
+template <typename T>
+T* AllocateHugeArray(size_t size) {
+    static_assert(alignof(T) <= kHugePageSize);
+    T* ptr = static_cast<T*>(MapHugePages(size * sizeof(T)));
+    if constexpr (!std::is_trivially_default_constructible_v<T>) {
+        try {
+            std::uninitialized_value_construct_n(ptr, size);
+        } catch (...) {
+            UnmapHugePages(ptr, size * sizeof(T));
+            throw;
+        }
+    }
+    return ptr;
+}
+
+template <typename T>
+using UniqueHugePtr = UniquePtr<T[], HugePageDeleter<T>>;
+
+// `MakeUniqueHuge<T>(size).GetDeleter().Size()` is the number of elements
+template <typename T>
+UniqueHugePtr<T> MakeUniqueHuge(size_t size) {
+    return UniqueHugePtr<T>(AllocateHugeArray<T>(size), HugePageDeleter<T>(size));
+}
+
+// Huge-page counterpart of `MakeShared<T[]>(size)`, the control block unmaps the region
+template <typename T>
+SharedPtr<T[]> MakeSharedHuge(size_t size) {
+    return SharedPtr<T[]>(AllocateHugeArray<T>(size), HugePageDeleter<T>(size));
+}
@@ -1,42 +1,43 @@
 #pragma once
 
 #include "compressed_pair.h"
+#include "compressed_tuple.h"
 #include <cstddef>  // std::nullptr_t
 
 template <typename T>
 struct Slug {
-    Slug() = default;
+    constexpr Slug() = default;
 
     template <typename U>
-    Slug(Slug<U>&&) {
+    constexpr Slug(Slug<U>&&) {
     }
 
     template <typename U>
-    Slug& operator=(Slug<U>&&) {
+    constexpr Slug& operator=(Slug<U>&&) {
         return *this;
     }
 
-    void operator()(T* ptr) {
+    constexpr void operator()(T* ptr) {
         delete ptr;
     };
 };
 
 template <typename T>
 struct Slug<T[]> {
-    Slug() = default;
-    Slug(Slug&) {
+    constexpr Slug() = default;
+    constexpr Slug(Slug&) {
     }
 
     template <typename U>
-    Slug(Slug<U>&&) {
+    constexpr Slug(Slug<U>&&) {
     }
 
     template <typename U>
-    Slug& operator=(Slug<U>&&) {
+    constexpr Slug& operator=(Slug<U>&&) {
         return *this;
     }
 
-    void operator()(T* ptr) {
+    constexpr void operator()(T* ptr) {
         delete[] ptr;
     };
 };
@@ -46,102 +47,102 @@ template <typename T, typename Deleter = Slug<T>>
 class UniquePtr {
 public:
     // Constructors
-    explicit UniquePtr(T* ptr = nullptr) : data_{ptr, Deleter()} {};
+    constexpr explicit UniquePtr(T* ptr = nullptr) : data_{ptr, Deleter()} {};
 
-    UniquePtr(T* ptr, Deleter deleter) : data_{ptr, std::forward<Deleter>(deleter)} {};
+    constexpr UniquePtr(T* ptr, Deleter deleter) : data_{ptr, std::forward<Deleter>(deleter)} {};
 
     template <typename U, typename D>
-    UniquePtr(UniquePtr<U, D>&& other) noexcept
+    constexpr UniquePtr(UniquePtr<U, D>&& other) noexcept
         : data_{other.Release(), std::forward<D>(other.GetDeleter())} {};
 
-    UniquePtr(UniquePtr& other) noexcept {
+    constexpr UniquePtr(UniquePtr& other) noexcept {
         data_ = other.data_;
     }
 
     // `operator=`-s
     template <typename U, typename D>
-    UniquePtr& operator=(UniquePtr<U, D>&& other) noexcept {
+    constexpr UniquePtr& operator=(UniquePtr<U, D>&& other) noexcept {
         if (Get() == other.Get()) {
             return *this;
         }
 
         Reset();
-        data_.GetFirst() = other.Release();
+        data_.template Get<0>() = other.Release();
         GetDeleter() = std::move(other.GetDeleter());
         return *this;
     };
 
-    UniquePtr& operator=(UniquePtr&& other) noexcept {
+    constexpr UniquePtr& operator=(UniquePtr&& other) noexcept {
         if (Get() == other.Get()) {
             return *this;
         }
 
         Reset();
-        data_.GetFirst() = other.Release();
+        data_.template Get<0>() = other.Release();
         GetDeleter() = std::move(other.GetDeleter());
         return *this;
     };
 
-    UniquePtr& operator=(std::nullptr_t) {
+    constexpr UniquePtr& operator=(std::nullptr_t) {
         Reset();
         return *this;
     };
 
     // Destructor
-    ~UniquePtr() {
+    constexpr ~UniquePtr() {
         Reset();
     };
 
     // Modifiers
-    T* Release() noexcept {
-        T* temp = data_.GetFirst();
-        data_.GetFirst() = nullptr;
+    constexpr T* Release() noexcept {
+        T* temp = data_.template Get<0>();
+        data_.template Get<0>() = nullptr;
         return temp;
     };
 
-    void Reset(T* ptr = nullptr) {
+    constexpr void Reset(T* ptr = nullptr) {
         T* temp = Get();
-        data_.GetFirst() = ptr;
+        data_.template Get<0>() = ptr;
 
         if (temp != nullptr) {
             GetDeleter()(temp);
         }
     };
 
-    void Swap(UniquePtr& other) {
-        std::swap(data_.GetFirst(), other.data_.GetFirst());
-        std::swap(data_.GetSecond(), other.data_.GetSecond());
+    constexpr void Swap(UniquePtr& other) {
+        std::swap(data_.template Get<0>(), other.data_.template Get<0>());
+        std::swap(data_.template Get<1>(), other.data_.template Get<1>());
     };
 
     // Observers
-    T* Get() const {
-        return data_.GetFirst();
+    constexpr T* Get() const {
+        return data_.template Get<0>();
     };
 
-    Deleter& GetDeleter() {
-        return data_.GetSecond();
+    constexpr Deleter& GetDeleter() {
+        return data_.template Get<1>();
     };
 
-    const Deleter& GetDeleter() const {
-        return data_.GetSecond();
+    constexpr const Deleter& GetDeleter() const {
+        return data_.template Get<1>();
     };
 
-    explicit operator bool() const {
-        return data_.GetFirst() != nullptr;
+    constexpr explicit operator bool() const {
+        return data_.template Get<0>() != nullptr;
     };
 
     // Single-object dereference operators
     template <typename U = T, typename = std::enable_if_t<!std::is_void_v<U>>>
-    U& operator*() const {
-        return *data_.GetFirst();
+    constexpr U& operator*() const {
+        return *data_.template Get<0>();
     };
 
-    T* operator->() const {
-        return data_.GetFirst();
+    constexpr T* operator->() const {
+        return data_.template Get<0>();
     };
 
 private:
-    CompressedPair<T*, Deleter> data_;
+    CompressedTuple<T*, Deleter> data_;
 };
 
 // Specialization for arrays
@@ -149,83 +150,89 @@ template <typename T, typename Deleter>
 class UniquePtr<T[], Deleter> {
 public:
     // Constructors
-    explicit UniquePtr(T* ptr = nullptr) : data_{ptr, Deleter()} {};
+    constexpr explicit UniquePtr(T* ptr = nullptr) : data_{ptr, Deleter()} {};
 
     // UniquePtr(T* ptr, Deleter deleter) : ptr_{ptr}, deleter_{deleter} {};
-    UniquePtr(T* ptr, Deleter deleter) : data_{ptr, deleter} {};
+    constexpr UniquePtr(T* ptr, Deleter deleter) : data_{ptr, std::forward<Deleter>(deleter)} {};
 
     template <typename U, typename D>
-    UniquePtr(UniquePtr<U, D>&& other) noexcept : data_{other.Release(), other.GetDeleter()} {};
+    constexpr UniquePtr(UniquePtr<U, D>&& other) noexcept
+        : data_{other.Release(), std::move(other.GetDeleter())} {};
 
     // `operator=`-s
     template <typename U, typename D>
-    UniquePtr& operator=(UniquePtr<U, D>&& other) noexcept {
-        GetDeleter()(Get());
-        data_.GetFirst() = other.Release();
-        data_.GetSecond() = other.GetDeleter();
+    constexpr UniquePtr& operator=(UniquePtr<U, D>&& other) noexcept {
+        if (Get() == other.Get()) {
+            return *this;
+        }
+
+        Reset(other.Release());
+        data_.template Get<1>() = std::move(other.GetDeleter());
         return *this;
     };
 
-    UniquePtr& operator=(std::nullptr_t) {
+    constexpr UniquePtr& operator=(std::nullptr_t) {
         Reset();
-        GetDeleter()(Get());
-        data_.GerFirst()(nullptr);
         return *this;
     };
 
-    T& operator[](size_t i) {
+    constexpr T& operator[](size_t i) {
         return Get()[i];
     }
 
     // Destructor
-    ~UniquePtr() {
+    constexpr ~UniquePtr() {
         Reset();
     };
 
     // Modifiers
-    T* Release() noexcept {
-        T* temp = data_.GetFirst();
-        data_.GetFirst() = nullptr;
+    constexpr T* Release() noexcept {
+        T* temp = data_.template Get<0>();
+        data_.template Get<0>() = nullptr;
         return temp;
     };
 
-    void Reset(T* ptr = nullptr) {
-        GetDeleter()(data_.GetFirst());
-        data_.GetFirst() = ptr;
+    constexpr void Reset(T* ptr = nullptr) {
+        T* temp = Get();
+        data_.template Get<0>() = ptr;
+
+        if (temp != nullptr) {
+            GetDeleter()(temp);
+        }
     };
 
-    void Swap(UniquePtr& other) {
-        std::swap(data_.GetFirst(), other.data_.GetFirst());
-        std::swap(data_.GetSecond(), other.data_.GetSecond());
+    constexpr void Swap(UniquePtr& other) {
+        std::swap(data_.template Get<0>(), other.data_.template Get<0>());
+        std::swap(data_.template Get<1>(), other.data_.template Get<1>());
     };
 
     // Observers
-    T* Get() const {
-        return data_.GetFirst();
+    constexpr T* Get() const {
+        return data_.template Get<0>();
     };
 
-    Deleter& GetDeleter() {
-        return data_.GetSecond();
+    constexpr Deleter& GetDeleter() {
+        return data_.template Get<1>();
     };
 
-    const Deleter& GetDeleter() const {
-        return data_.GetSecond();
+    constexpr const Deleter& GetDeleter() const {
+        return data_.template Get<1>();
     };
 
-    explicit operator bool() const {
-        return data_.GetFirst() != nullptr;
+    constexpr explicit operator bool() const {
+        return data_.template Get<0>() != nullptr;
     };
 
     // Single-object dereference operators
     template <typename U = T, typename = std::enable_if_t<!std::is_void_v<U>>>
-    U& operator*() const {
-        return *data_.GetFirst();
+    constexpr U& operator*() const {
+        return *data_.template Get<0>();
     };
 
-    T* operator->() const {
-        return data_.GetFirst();
+    constexpr T* operator->() const {
+        return data_.template Get<0>();
     };
 
 private:
-    CompressedPair<T*, Deleter> data_;
+    CompressedTuple<T*, Deleter> data_;
 };
@@ -0,0 +1,190 @@
+#pragma once
+
+#include "huge_pages.h"
+#include "unique.h"
+#include <cstddef>  // size_t
+#include <memory>   // std::assume_aligned, std::uninitialized_*
+#include <new>      // std::align_val_t
+#include <span>
+#include <type_traits>
+#include <utility>
+
+// Default alignment of `UniqueArray`: a cache line, enough for AVX-512 loads.
+inline constexpr size_t kDefaultArrayAlignment = 64;
+
+// Destroys `size` elements and frees memory allocated with `Align` alignment.
+// The element count lives here, so `UniqueArray` carries it for free inside `UniquePtr`.
+// Alignments of `kHugePageSize` and above are served by `MapHugePages`, which maps a region
+// aligned to `Align` itself rather than only to a huge page.
+template <typename T, size_t Align>
+class AlignedArrayDeleter {
+public:
+    AlignedArrayDeleter() = default;
+
+    explicit AlignedArrayDeleter(size_t size) : size_(size) {
+    }
+
+    AlignedArrayDeleter(const AlignedArrayDeleter&) = delete;
+
+    AlignedArrayDeleter(AlignedArrayDeleter&& rhs) noexcept : size_(std::exchange(rhs.size_, 0)) {
+    }
+
+    AlignedArrayDeleter& operator=(const AlignedArrayDeleter&) = delete;
+
+    AlignedArrayDeleter& operator=(AlignedArrayDeleter&& rhs) noexcept {
+        size_ = std::exchange(rhs.size_, 0);
+        return *this;
+    }
+
+    size_t Size() const {
+        return size_;
+    }
+
+    static T* Allocate(size_t size) {
+        if constexpr (Align >= kHugePageSize) {
+            return static_cast<T*>(MapHugePages(size * sizeof(T), Align));
+        } else {
+            return static_cast<T*>(::operator new(size * sizeof(T), std::align_val_t{Align}));
+        }
+    }
+
+    static void Deallocate(T* ptr, size_t size) {
+        if constexpr (Align >= kHugePageSize) {
+            UnmapHugePages(ptr, size * sizeof(T));
+        } else {
+            ::operator delete(ptr, std::align_val_t{Align});
+        }
+    }
+
+    void operator()(T* ptr) const {
+        std::destroy_n(ptr, size_);
+        Deallocate(ptr, size_);
+    }
+
+private:
+    size_t size_ = 0;
+};
+
+// Owning array that knows its length and allocates with the chosen alignment.
+template <typename T, size_t Align = kDefaultArrayAlignment>
+class UniqueArray {
+    static_assert(Align >= alignof(T), "Alignment is weaker than the element alignment");
+    static_assert((Align & (Align - 1)) == 0, "Alignment must be a power of two");
+
+private:
+    using ArrayDeleter = AlignedArrayDeleter<T, Align>;
+
+    // Allocates `size` elements and initializes them with `init(ptr, size)`.
+    template <typename Init>
+    static UniquePtr<T[], ArrayDeleter> Allocate(size_t size, Init init) {
+        if (size == 0) {
+            return UniquePtr<T[], ArrayDeleter>();
+        }
+
+        T* ptr = ArrayDeleter::Allocate(size);
+        try {
+            init(ptr, size);
+        } catch (...) {
+            ArrayDeleter::Deallocate(ptr, size);
+            throw;
+        }
+        return UniquePtr<T[], ArrayDeleter>(ptr, ArrayDeleter(size));
+    }
+
+    explicit UniqueArray(UniquePtr<T[], ArrayDeleter>&& data) : data_(std::move(data)) {
+    }
+
+public:
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    UniqueArray() = default;
+
+    // Value-initialized elements (zeroes for arithmetic types)
+    explicit UniqueArray(size_t size)
+        : data_(Allocate(size, [](T* ptr, size_t n) {
+              std::uninitialized_value_construct_n(ptr, n);
+          })) {
+    }
+
+    UniqueArray(size_t size, const T& value)
+        : data_(Allocate(size, [&value](T* ptr, size_t n) {
+              std::uninitialized_fill_n(ptr, n, value);
+          })) {
+    }
+
+    // Skips initialization, the caller is expected to overwrite every element
+    static UniqueArray Uninitialized(size_t size) {
+        static_assert(std::is_trivially_default_constructible_v<T> &&
+                          std::is_trivially_destructible_v<T>,
+                      "Uninitialized storage is allowed only for trivial types");
+        return UniqueArray(Allocate(size, [](T*, size_t) {}));
+    }
+
+    UniqueArray(UniqueArray&& other) noexcept : data_(std::move(other.data_)) {
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // `operator=`-s
+
+    UniqueArray& operator=(UniqueArray&& other) noexcept {
+        data_ = std::move(other.data_);
+        return *this;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+
+    void Reset() {
+        data_.Reset();
+        data_.GetDeleter() = ArrayDeleter();
+    }
+
+    void Swap(UniqueArray& other) {
+        data_.Swap(other.data_);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    // Tells the compiler about the alignment, so loops over the data get aligned vector loads
+    T* Data() const {
+        T* ptr = data_.Get();
+        return ptr == nullptr ? ptr : std::assume_aligned<Align>(ptr);
+    }
+
+    size_t Size() const {
+        return data_.GetDeleter().Size();
+    }
+
+    bool Empty() const {
+        return Size() == 0;
+    }
+
+    T& operator[](size_t i) const {
+        return Data()[i];
+    }
+
+    T* begin() const {
+        return Data();
+    }
+
+    T* end() const {
+        return Data() + Size();
+    }
+
+    std::span<T> Span() const {
+        return {Data(), Size()};
+    }
+
+    operator std::span<T>() const {
+        return Span();
+    }
+
+    operator std::span<const T>() const {
+        return Span();
+    }
+
+private:
+    UniquePtr<T[], ArrayDeleter> data_;
+};
@@ -0,0 +1,192 @@
+#pragma once
+
+#include "../function/function.h"
+#include "weak.h"
+#include <cstdint>
+#include <iterator>  // std::next
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class ExpirySubscription;
+
+// Callbacks run when the last `SharedPtr` to an object goes away, so indexes keyed by `WeakPtr`
+// can drop an entry the moment its object dies instead of sweeping for expired ones.
+// Listeners live in a process-wide table keyed by control block; a block with listeners is marked
+// by a bit of its weak count, so blocks without any pay a single branch in `IBlock::DecShared`.
+//
+// Callbacks run right after the object is destroyed, on the thread that released it, and must
+// not throw.
+class ExpiryRegistry {
+public:
+    using Callback = UniqueFunction<void()>;
+
+    static ExpiryRegistry& Global() {
+        static ExpiryRegistry registry;
+        return registry;
+    }
+
+    // Empty subscription (and no call) if `ptr` is already expired
+    template <typename T>
+    ExpirySubscription Subscribe(const WeakPtr<T>& ptr, Callback callback);
+
+    template <typename T>
+    ExpirySubscription Subscribe(const SharedPtr<T>& ptr, Callback callback);
+
+    size_t ListenerCount() {
+        std::lock_guard lock(mutex_);
+        return listener_count_;
+    }
+
+private:
+    friend class ExpirySubscription;
+
+    struct Listener {
+        uint64_t id;
+        Callback callback;
+    };
+
+    ExpiryRegistry() = default;
+
+    ExpirySubscription Subscribe(IBlock* block, Callback callback);
+
+    void Cancel(IBlock* block, uint64_t id) {
+        std::lock_guard lock(mutex_);
+        // Listeners of a dead block are gone already
+        auto [begin, end] = listeners_.equal_range(block);
+        for (auto it = begin; it != end; ++it) {
+            if (it->second.id == id) {
+                bool last = std::next(begin) == end;
+                listeners_.erase(it);
+                --listener_count_;
+                if (last) {
+                    block->weak_count_.fetch_and(~IBlock::kListenedFlag);
+                }
+                return;
+            }
+        }
+    }
+
+    static void Notify(IBlock* block) {
+        ExpiryRegistry& registry = Global();
+        std::vector<Callback> fired;
+        {
+            std::lock_guard lock(registry.mutex_);
+            auto [begin, end] = registry.listeners_.equal_range(block);
+            for (auto it = begin; it != end; ++it) {
+                fired.push_back(std::move(it->second.callback));
+            }
+            registry.listeners_.erase(begin, end);
+            registry.listener_count_ -= fired.size();
+            block->weak_count_.fetch_and(~IBlock::kListenedFlag);
+        }
+        // Callbacks may subscribe or cancel, so they run without the lock
+        for (Callback& callback : fired) {
+            callback();
+        }
+    }
+
+    std::mutex mutex_;
+    std::unordered_multimap<IBlock*, Listener> listeners_;
+    // Ids are never reused, so a stale subscription cannot cancel a listener of a new block
+    // allocated at the same address
+    uint64_t next_id_ = 1;
+    size_t listener_count_ = 0;
+};
+
+// Registered expiry callback, cancelled when the subscription is destroyed
+class ExpirySubscription {
+public:
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    ExpirySubscription() = default;
+
+    ExpirySubscription(const ExpirySubscription&) = delete;
+
+    ExpirySubscription(ExpirySubscription&& other) noexcept
+        : block_{std::exchange(other.block_, nullptr)}, id_{other.id_} {
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // `operator=`-s
+
+    ExpirySubscription& operator=(const ExpirySubscription&) = delete;
+
+    ExpirySubscription& operator=(ExpirySubscription&& other) noexcept {
+        if (this != &other) {
+            Cancel();
+            block_ = std::exchange(other.block_, nullptr);
+            id_ = other.id_;
+        }
+        return *this;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Destructor
+
+    ~ExpirySubscription() {
+        Cancel();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+
+    void Cancel() {
+        if (block_ != nullptr) {
+            ExpiryRegistry::Global().Cancel(std::exchange(block_, nullptr), id_);
+        }
+    }
+
+    // Leaves the callback registered until the object dies
+    void Release() {
+        block_ = nullptr;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    explicit operator bool() const {
+        return block_ != nullptr;
+    }
+
+private:
+    friend class ExpiryRegistry;
+
+    ExpirySubscription(IBlock* block, uint64_t id) : block_{block}, id_{id} {
+    }
+
+    IBlock* block_ = nullptr;
+    uint64_t id_ = 0;
+};
+
+inline ExpirySubscription ExpiryRegistry::Subscribe(IBlock* block, Callback callback) {
+    if (block == nullptr || block->SharedCount() == 0) {
+        return ExpirySubscription();
+    }
+    std::lock_guard lock(mutex_);
+    uint64_t id = next_id_++;
+    listeners_.emplace(block, Listener{id, std::move(callback)});
+    ++listener_count_;
+    // The hook is in place before any block is marked
+    IBlock::expiry_hook_.store(&ExpiryRegistry::Notify, std::memory_order_release);
+    block->weak_count_.fetch_or(IBlock::kListenedFlag, std::memory_order_release);
+    return ExpirySubscription(block, id);
+}
+
+template <typename T>
+ExpirySubscription ExpiryRegistry::Subscribe(const WeakPtr<T>& ptr, Callback callback) {
+    return Subscribe(ptr.ctrl_block_, std::move(callback));
+}
+
+template <typename T>
+ExpirySubscription ExpiryRegistry::Subscribe(const SharedPtr<T>& ptr, Callback callback) {
+    return Subscribe(ptr.ctrl_block_, std::move(callback));
+}
+
+// Calls `callback()` once the object `ptr` refers to is destroyed
+template <typename Ptr>
+ExpirySubscription OnExpired(const Ptr& ptr, ExpiryRegistry::Callback callback) {
+    return ExpiryRegistry::Global().Subscribe(ptr, std::move(callback));
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "weak.h"
+#include <cstddef>  // size_t
+
+// Functors over the `Owner*` members of `SharedPtr` and `WeakPtr`, for ordered and hashed
+// containers keyed by object identity. They are transparent, so a map keyed by `WeakPtr<T>`
+// can be searched with a `SharedPtr<T>` without creating a weak reference.
+
+struct OwnerLess {
+    using is_transparent = void;
+
+    template <typename A, typename B>
+    bool operator()(const A& lhs, const B& rhs) const {
+        return lhs.OwnerBefore(rhs);
+    }
+};
+
+struct OwnerEqual {
+    using is_transparent = void;
+
+    template <typename A, typename B>
+    bool operator()(const A& lhs, const B& rhs) const {
+        return lhs.OwnerEqual(rhs);
+    }
+};
+
+struct OwnerHash {
+    using is_transparent = void;
+
+    template <typename P>
+    size_t operator()(const P& ptr) const {
+        return ptr.OwnerHash();
+    }
+};
@@ -6,12 +6,17 @@
 template <typename T>
 class WeakPtr {
 private:
-    T* ptr_ = nullptr;
+    std::remove_extent_t<T>* ptr_ = nullptr;
     IBlock* ctrl_block_ = nullptr;
 
     template <typename Y>
     friend class SharedPtr;
 
+    template <typename Y>
+    friend class WeakPtr;
+
+    friend class ExpiryRegistry;
+
 public:
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // Constructors
@@ -126,6 +131,36 @@ public:
     };
 
     SharedPtr<T> Lock() const {
-        return Expired() ? SharedPtr<T>() : SharedPtr<T>(*this);
+        SharedPtr<T> result;
+        if (ctrl_block_ != nullptr && ctrl_block_->TryIncShared()) {
+            result.ptr_ = ptr_;
+            result.ctrl_block_ = ctrl_block_;
+        }
+        return result;
+    };
+
+    // Same as `SharedPtr::OwnerBefore` and friends
+    template <typename Y>
+    bool OwnerBefore(const SharedPtr<Y>& other) const {
+        return std::less<const IBlock*>()(ctrl_block_, other.ctrl_block_);
+    };
+
+    template <typename Y>
+    bool OwnerBefore(const WeakPtr<Y>& other) const {
+        return std::less<const IBlock*>()(ctrl_block_, other.ctrl_block_);
+    };
+
+    template <typename Y>
+    bool OwnerEqual(const SharedPtr<Y>& other) const {
+        return ctrl_block_ == other.ctrl_block_;
+    };
+
+    template <typename Y>
+    bool OwnerEqual(const WeakPtr<Y>& other) const {
+        return ctrl_block_ == other.ctrl_block_;
+    };
+
+    size_t OwnerHash() const {
+        return std::hash<const IBlock*>()(ctrl_block_);
     };
 };
@@ -0,0 +1,218 @@
+#pragma once
+
+#include "weak.h"
+#include <cstddef>  // size_t
+#include <optional>
+#include <utility>
+#include <vector>
+
+// Hash map keyed by object identity that does not keep its keys alive.
+// Keys are `WeakPtr<K>`s compared and hashed by control block, so any `SharedPtr` or `WeakPtr`
+// sharing ownership of the object finds the entry. Open addressing with linear probing and
+// backward-shift deletion, so there are no tombstones: an insert or erase whose probe meets an
+// entry with an expired key removes it on the spot, and a table that fills up is first swept for
+// expired keys in place and only grows if the live ones still need the room.
+template <typename K, typename V>
+class WeakKeyMap {
+private:
+    static constexpr size_t kMinCapacity = 16;
+
+    // Empty slots have no value
+    struct Slot {
+        WeakPtr<K> key;
+        std::optional<V> value;
+    };
+
+public:
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+
+    // Returns true if `key` was not in the map; does nothing for an expired key
+    template <typename Ptr>
+    bool Set(const Ptr& key, V value) {
+        if (key.UseCount() == 0) {
+            return false;
+        }
+        if ((size_ + 1) * 4 > slots_.size() * 3) {
+            MakeRoom();
+        }
+        auto [index, found] = Probe(key);
+        Slot& slot = slots_[index];
+        if (found) {
+            *slot.value = std::move(value);
+            return false;
+        }
+        slot.key = WeakPtr<K>(key);
+        slot.value.emplace(std::move(value));
+        ++size_;
+        return true;
+    }
+
+    template <typename Ptr>
+    bool Erase(const Ptr& key) {
+        if (slots_.empty()) {
+            return false;
+        }
+        auto [index, found] = Probe(key);
+        if (!found) {
+            return false;
+        }
+        EraseAt(index);
+        return true;
+    }
+
+    void Clear() {
+        slots_.clear();
+        size_ = 0;
+    }
+
+    // Removes every expired entry now
+    void Purge() {
+        if (!slots_.empty()) {
+            Sweep();
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    // Null if `key` is not in the map or has expired
+    template <typename Ptr>
+    V* Find(const Ptr& key) {
+        if (slots_.empty()) {
+            return nullptr;
+        }
+        auto [index, found] = Probe<false>(key);
+        if (!found || slots_[index].key.Expired()) {
+            return nullptr;
+        }
+        return &*slots_[index].value;
+    }
+
+    template <typename Ptr>
+    bool Contains(const Ptr& key) {
+        return Find(key) != nullptr;
+    }
+
+    // Entries, including those whose keys expired and have not been removed yet
+    size_t EntryCount() const {
+        return size_;
+    }
+
+    // Calls `f(const SharedPtr<K>&, V&)` for every entry whose key is alive
+    template <typename F>
+    void ForEach(F&& f) {
+        for (Slot& slot : slots_) {
+            if (!slot.value) {
+                continue;
+            }
+            SharedPtr<K> key = slot.key.Lock();
+            if (key) {
+                f(key, *slot.value);
+            }
+        }
+    }
+
+private:
+    // Spreads block addresses, whose low bits are always zero
+    template <typename Ptr>
+    size_t HomeOf(const Ptr& key) const {
+        size_t hash = key.OwnerHash() * 0x9E3779B97F4A7C15ull;
+        return (hash ^ (hash >> 32)) & (slots_.size() - 1);
+    }
+
+    // Index of the slot holding `key` and true, or of the slot to insert it into and false.
+    // With `kReclaim`, expired entries met on the way are erased; that reads the control block
+    // of every key passed over, so lookups leave it to inserts and erases and only compare
+    // addresses (a block is never reused while a slot holds a weak reference to it), which may
+    // find the entry of an expired key.
+    template <bool kReclaim = true, typename Ptr>
+    std::pair<size_t, bool> Probe(const Ptr& key) {
+        size_t mask = slots_.size() - 1;
+        size_t index = HomeOf(key);
+        while (true) {
+            Slot& slot = slots_[index];
+            if (!slot.value) {
+                return {index, false};
+            }
+            if (kReclaim && slot.key.Expired()) {
+                // The next entry of the cluster may move here, so the slot is looked at again
+                EraseAt(index);
+                continue;
+            }
+            if (slot.key.OwnerEqual(key)) {
+                return {index, true};
+            }
+            index = (index + 1) & mask;
+        }
+    }
+
+    // Moves back the entries after `hole` whose probe passes over it, then empties the last slot
+    // left behind, so the following lookups never meet a gap in their cluster
+    void EraseAt(size_t hole) {
+        size_t mask = slots_.size() - 1;
+        for (size_t index = (hole + 1) & mask; slots_[index].value; index = (index + 1) & mask) {
+            Slot& slot = slots_[index];
+            size_t home = HomeOf(slot.key);
+            if (((index - home) & mask) >= ((index - hole) & mask)) {
+                slots_[hole].key = std::move(slot.key);
+                slots_[hole].value = std::move(slot.value);
+                hole = index;
+            }
+        }
+        slots_[hole].key.Reset();
+        slots_[hole].value.reset();
+        --size_;
+    }
+
+    // Erases every expired entry in one pass, starting after an empty slot so that entries
+    // shifted back by an erase are never ones passed already
+    void Sweep() {
+        size_t mask = slots_.size() - 1;
+        size_t start = 0;
+        while (slots_[start].value) {
+            ++start;
+        }
+        size_t index = (start + 1) & mask;
+        while (index != start) {
+            Slot& slot = slots_[index];
+            if (slot.value && slot.key.Expired()) {
+                EraseAt(index);
+                continue;
+            }
+            index = (index + 1) & mask;
+        }
+    }
+
+    // Sweeps a full table and grows it only if the live entries take more than half of it;
+    // the new table is at most a quarter full, so dead keys have room to pile up between sweeps
+    void MakeRoom() {
+        if (!slots_.empty()) {
+            Sweep();
+        }
+        if ((size_ + 1) * 2 <= slots_.size()) {
+            return;
+        }
+        size_t capacity = kMinCapacity;
+        while (capacity < (size_ + 1) * 4) {
+            capacity *= 2;
+        }
+
+        std::vector<Slot> old = std::exchange(slots_, std::vector<Slot>(capacity));
+        size_t mask = capacity - 1;
+        for (Slot& slot : old) {
+            if (!slot.value) {
+                continue;
+            }
+            size_t index = HomeOf(slot.key);
+            while (slots_[index].value) {
+                index = (index + 1) & mask;
+            }
+            slots_[index].key = std::move(slot.key);
+            slots_[index].value = std::move(slot.value);
+        }
+    }
+
+    std::vector<Slot> slots_;
+    size_t size_ = 0;
+};
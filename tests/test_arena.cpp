@@ -0,0 +1,142 @@
+#include "../src/arena/arena.h"
+#include "../src/weak/weak.h"
+#include "./my_int.h"
+#include <string>
+#include <vector>
+
+#define REQUIRE(b)                                                             \
+  {                                                                            \
+    if (!(b)) {                                                                \
+      std::cout << "WRONG" << std::endl;                                       \
+    };                                                                         \
+  }
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct ArenaNode : SimpleRefCounted<ArenaNode, ArenaDelete> {
+  explicit ArenaNode(int value) : value{value} {}
+  MyInt value;
+};
+
+struct alignas(64) Wide {
+  char data[64] = {};
+};
+
+struct Throwing {
+  Throwing() { throw 1; }
+};
+
+void TestArenaAllocate() {
+  // "Allocations are aligned and come from few chunks"
+  {
+    Arena arena;
+    for (int i = 0; i < 1000; ++i) {
+      void *ptr = arena.Allocate(24, 8);
+      REQUIRE(reinterpret_cast<uintptr_t>(ptr) % 8 == 0);
+      void *wide = arena.Allocate<Wide>();
+      REQUIRE(reinterpret_cast<uintptr_t>(wide) % 64 == 0);
+    }
+    REQUIRE(arena.LiveCount() == 2000);
+    REQUIRE(arena.Capacity() < 2 * 1000 * (24 + 64 + 64));
+    for (int i = 0; i < 2000; ++i) {
+      arena.Release();
+    }
+  }
+
+  // "Allocation larger than a chunk"
+  {
+    Arena arena(64);
+    auto *big = static_cast<char *>(arena.Allocate(1 << 16, 16));
+    big[(1 << 16) - 1] = 1;
+    REQUIRE(arena.Capacity() >= (1 << 16));
+    arena.Release();
+  }
+}
+
+void TestMakeSharedIn() {
+  // "Objects die with their last owner"
+  {
+    Arena arena;
+    {
+      SharedPtr<MyInt> first = MakeSharedIn<MyInt>(arena, 1);
+      SharedPtr<MyInt> copy = first;
+      SharedPtr<std::string> str = MakeSharedIn<std::string>(arena, 100, 'x');
+      REQUIRE(*first == 1);
+      REQUIRE(first.UseCount() == 2);
+      REQUIRE(str->size() == 100);
+      REQUIRE(MyInt::AliveCount() == 1);
+      REQUIRE(arena.LiveCount() == 2);
+    }
+    REQUIRE(MyInt::AliveCount() == 0);
+    REQUIRE(arena.LiveCount() == 0);
+  }
+
+  // "Weak pointers keep only the block"
+  {
+    Arena arena;
+    WeakPtr<MyInt> weak;
+    {
+      SharedPtr<MyInt> shared = MakeSharedIn<MyInt>(arena, 5);
+      weak = shared;
+    }
+    REQUIRE(weak.Expired());
+    REQUIRE(MyInt::AliveCount() == 0);
+    REQUIRE(arena.LiveCount() == 1);
+    weak.Reset();
+    REQUIRE(arena.LiveCount() == 0);
+  }
+
+  // "Throwing constructor"
+  {
+    Arena arena;
+    bool thrown = false;
+    try {
+      MakeSharedIn<Throwing>(arena);
+    } catch (int) {
+      thrown = true;
+    }
+    REQUIRE(thrown);
+    REQUIRE(arena.LiveCount() == 0);
+  }
+}
+
+void TestMakeIntrusiveIn() {
+  // "Intrusive objects in an arena"
+  {
+    Arena arena;
+    {
+      std::vector<IntrusivePtr<ArenaNode>> nodes;
+      for (int i = 0; i < 100; ++i) {
+        nodes.push_back(MakeIntrusiveIn<ArenaNode>(arena, i));
+      }
+      IntrusivePtr<ArenaNode> copy = nodes[42];
+      REQUIRE(copy->value == 42);
+      REQUIRE(copy.UseCount() == 2);
+      REQUIRE(MyInt::AliveCount() == 100);
+      REQUIRE(arena.LiveCount() == 100);
+    }
+    REQUIRE(MyInt::AliveCount() == 0);
+    REQUIRE(arena.LiveCount() == 0);
+  }
+}
+
+void TestMakeUniqueIn() {
+  // "Unique objects in an arena"
+  {
+    Arena arena;
+    {
+      ArenaUniquePtr<MyInt> value = MakeUniqueIn<MyInt>(arena, 3);
+      ArenaUniquePtr<Wide> wide = MakeUniqueIn<Wide>(arena);
+      REQUIRE(*value == 3);
+      REQUIRE(reinterpret_cast<uintptr_t>(wide.Get()) % 64 == 0);
+      REQUIRE(arena.LiveCount() == 2);
+
+      ArenaUniquePtr<MyInt> moved = std::move(value);
+      REQUIRE(!value);
+      moved.Reset();
+      REQUIRE(MyInt::AliveCount() == 0);
+      REQUIRE(arena.LiveCount() == 1);
+    }
+    REQUIRE(arena.LiveCount() == 0);
+  }
+}
@@ -0,0 +1,183 @@
+#include "../src/shared/buffer_chain.h"
+#include <string>
+#include <string_view>
+#include <unistd.h>
+
+#define REQUIRE(b)                                                             \
+  {                                                                            \
+    if (!(b)) {                                                                \
+      std::cout << "WRONG" << std::endl;                                       \
+    };                                                                         \
+  }
+
+////////////////////////////////////////////////////////////////////////////////
+
+SharedBytes Bytes(std::string_view text) {
+  return MakeSharedBytes(std::as_bytes(std::span(text)));
+}
+
+std::string ToString(const BufferChain &chain) {
+  std::string result;
+  chain.ForEachSegment([&result](const SharedBytes &bytes) {
+    result.append(reinterpret_cast<const char *>(bytes.Data()), bytes.Size());
+  });
+  return result;
+}
+
+void TestAppend() {
+  // "Empty chain"
+  {
+    BufferChain chain;
+    REQUIRE(chain.Empty());
+    REQUIRE(chain.SegmentCount() == 0);
+    REQUIRE(chain.Coalesce().Empty());
+  }
+
+  // "Append shares the slices"
+  {
+    SharedBytes hello = Bytes("hello, ");
+    BufferChain chain(hello);
+    chain.Append(Bytes("world"));
+    chain.Append(SharedBytes());
+
+    REQUIRE(chain.Size() == 12);
+    REQUIRE(chain.SegmentCount() == 2);
+    REQUIRE(hello.UseCount() == 2);
+    REQUIRE(ToString(chain) == "hello, world");
+  }
+
+  // "Append chain"
+  {
+    BufferChain a(Bytes("ab"));
+    BufferChain b(Bytes("cd"));
+    b.Append(Bytes("ef"));
+
+    a.Append(std::move(b));
+    REQUIRE(b.Empty());
+    REQUIRE(a.SegmentCount() == 3);
+    REQUIRE(ToString(a) == "abcdef");
+
+    a.Append(Bytes("g"));
+    REQUIRE(ToString(a) == "abcdefg");
+  }
+}
+
+void TestSplit() {
+  // "Split on segment boundary and inside a segment"
+  {
+    BufferChain chain(Bytes("abc"));
+    chain.Append(Bytes("defgh"));
+
+    BufferChain front = chain.Split(3);
+    REQUIRE(ToString(front) == "abc");
+    REQUIRE(ToString(chain) == "defgh");
+
+    front = chain.Split(2);
+    REQUIRE(ToString(front) == "de");
+    REQUIRE(ToString(chain) == "fgh");
+    REQUIRE(chain.Size() == 3);
+    REQUIRE(chain.SegmentCount() == 1);
+  }
+
+  // "Trim"
+  {
+    BufferChain chain(Bytes("abc"));
+    chain.Append(Bytes("def"));
+    chain.TrimFront(4);
+    REQUIRE(ToString(chain) == "ef");
+    chain.TrimFront(2);
+    REQUIRE(chain.Empty());
+    REQUIRE(chain.SegmentCount() == 0);
+  }
+}
+
+void TestCoalesce() {
+  // "Single segment is returned as is"
+  {
+    SharedBytes bytes = Bytes("abc");
+    BufferChain chain(bytes);
+    REQUIRE(chain.Coalesce().Data() == bytes.Data());
+  }
+
+  // "Several segments are joined"
+  {
+    BufferChain chain(Bytes("ab"));
+    chain.Append(Bytes("cd"));
+    SharedBytes joined = chain.Coalesce();
+    REQUIRE(joined.Size() == 4);
+    REQUIRE(chain.SegmentCount() == 1);
+    REQUIRE(ToString(chain) == "abcd");
+  }
+
+  // "Clone shares the payload"
+  {
+    SharedBytes bytes = Bytes("abc");
+    BufferChain chain(bytes);
+    BufferChain clone = chain.Clone();
+    REQUIRE(ToString(clone) == "abc");
+    REQUIRE(bytes.UseCount() == 3);
+  }
+}
+
+void TestIovecs() {
+  // "Writev"
+  {
+    BufferChain chain(Bytes("scatter"));
+    chain.Append(Bytes("/"));
+    chain.Append(Bytes("gather"));
+
+    int fds[2];
+    REQUIRE(pipe(fds) == 0);
+    std::vector<iovec> iov = chain.ToIovecs();
+    REQUIRE(iov.size() == 3);
+    REQUIRE(writev(fds[1], iov.data(), iov.size()) == 14);
+
+    char buffer[32] = {};
+    REQUIRE(read(fds[0], buffer, sizeof(buffer)) == 14);
+    REQUIRE(std::string_view(buffer) == "scatter/gather");
+    close(fds[0]);
+    close(fds[1]);
+  }
+
+  // "Partial fill"
+  {
+    BufferChain chain(Bytes("a"));
+    chain.Append(Bytes("b"));
+    iovec iov[1];
+    REQUIRE(chain.FillIovecs(iov) == 1);
+    REQUIRE(iov[0].iov_len == 1);
+  }
+
+  // "Readv into reserved segments"
+  {
+    int fds[2];
+    REQUIRE(pipe(fds) == 0);
+    REQUIRE(write(fds[1], "scatter/gather", 14) == 14);
+
+    BufferChain chain(Bytes(">"));
+    iovec iov[3];
+    chain.ReserveIovecs(iov, 8);
+    REQUIRE(chain.Size() == 1);
+    ssize_t count = readv(fds[0], iov, 3);
+    REQUIRE(count == 14);
+    chain.CommitRead(count);
+    REQUIRE(chain.Size() == 15);
+    REQUIRE(chain.SegmentCount() == 3);
+    REQUIRE(ToString(chain) == ">scatter/gather");
+    close(fds[0]);
+    close(fds[1]);
+  }
+}
+
+void TestSegmentPool() {
+  // "Headers are reused"
+  {
+    SegmentPool &pool = SegmentPool::Local();
+    { BufferChain chain(Bytes("abc")); }
+    size_t free_count = pool.FreeCount();
+    REQUIRE(free_count > 0);
+
+    BufferChain chain(Bytes("abc"));
+    REQUIRE(pool.FreeCount() == free_count - 1);
+  }
+}
@@ -0,0 +1,175 @@
+#include "../src/arena/compressed_ptr.h"
+#include "../src/intrusive/intrusive.h"
+#include "./my_int.h"
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#define REQUIRE(b)                                                             \
+  {                                                                            \
+    if (!(b)) {                                                                \
+      std::cout << "WRONG" << std::endl;                                       \
+    };                                                                         \
+  }
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct GraphNode : SimpleRefCounted<GraphNode, CompressedArenaDelete> {
+  explicit GraphNode(int value) : value{value} {}
+  MyInt value;
+  CompressedIntrusivePtr<GraphNode> left;
+  CompressedIntrusivePtr<GraphNode> right;
+};
+
+struct ListNode {
+  explicit ListNode(int value) : value{value} {}
+  MyInt value;
+  CompressedUniquePtr<ListNode> next;
+};
+
+struct Throwing : SimpleRefCounted<Throwing, CompressedArenaDelete> {
+  Throwing() { throw 1; }
+};
+
+void TestCompressedIntrusivePtr() {
+  static_assert(sizeof(CompressedIntrusivePtr<GraphNode>) == 4);
+
+  // "Refcount semantics"
+  {
+    CompressedArena arena(1 << 20);
+    {
+      CompressedIntrusivePtr<GraphNode> root = MakeCompressedIntrusive<GraphNode>(1);
+      root->left = MakeCompressedIntrusive<GraphNode>(2);
+      root->right = root->left;
+      REQUIRE(root->left.UseCount() == 2);
+      REQUIRE(root->right->value == 2);
+      REQUIRE(reinterpret_cast<uintptr_t>(root.Get()) % CompressedArena::kScale == 0);
+      REQUIRE(arena.LiveCount() == 2);
+
+      CompressedIntrusivePtr<GraphNode> copy = root;
+      REQUIRE(copy.UseCount() == 2);
+      CompressedIntrusivePtr<GraphNode> moved = std::move(copy);
+      REQUIRE(!copy);
+      REQUIRE(moved.Get() == root.Get());
+      REQUIRE(root.UseCount() == 2);
+
+      root->left.Reset();
+      REQUIRE(root->right.UseCount() == 1);
+      REQUIRE(MyInt::AliveCount() == 2);
+    }
+    REQUIRE(MyInt::AliveCount() == 0);
+    REQUIRE(arena.LiveCount() == 0);
+  }
+
+  // "Null pointers"
+  {
+    CompressedIntrusivePtr<GraphNode> empty;
+    REQUIRE(!empty);
+    REQUIRE(empty.Get() == nullptr);
+    REQUIRE(empty.UseCount() == 0);
+    CompressedIntrusivePtr<GraphNode> null = nullptr;
+    REQUIRE(!null);
+  }
+
+  // "Assignment and swap"
+  {
+    CompressedArena arena(1 << 20);
+    {
+      auto a = MakeCompressedIntrusive<GraphNode>(1);
+      auto b = MakeCompressedIntrusive<GraphNode>(2);
+      a = b;
+      REQUIRE(MyInt::AliveCount() == 1);
+      REQUIRE(b.UseCount() == 2);
+      a = a;
+      REQUIRE(b.UseCount() == 2);
+      a.Reset(MakeCompressedIntrusive<GraphNode>(3).Get());
+      REQUIRE(a->value == 3);
+      a.Swap(b);
+      REQUIRE(a->value == 2);
+      REQUIRE(b->value == 3);
+    }
+    REQUIRE(arena.LiveCount() == 0);
+  }
+
+  // "Throwing constructor"
+  {
+    CompressedArena arena(1 << 20);
+    bool thrown = false;
+    try {
+      MakeCompressedIntrusive<Throwing>();
+    } catch (int) {
+      thrown = true;
+    }
+    REQUIRE(thrown);
+    REQUIRE(arena.LiveCount() == 0);
+  }
+}
+
+void TestCompressedUniquePtr() {
+  static_assert(sizeof(CompressedUniquePtr<ListNode>) == 4);
+
+  // "Ownership semantics"
+  {
+    CompressedArena arena(1 << 20);
+    {
+      CompressedUniquePtr<ListNode> head = MakeCompressedUnique<ListNode>(0);
+      ListNode *tail = head.Get();
+      for (int i = 1; i < 100; ++i) {
+        tail->next = MakeCompressedUnique<ListNode>(i);
+        tail = tail->next.Get();
+      }
+      REQUIRE(MyInt::AliveCount() == 100);
+      REQUIRE(head->next->next->value == 2);
+
+      CompressedUniquePtr<ListNode> moved = std::move(head);
+      REQUIRE(!head);
+      REQUIRE(moved->value == 0);
+
+      moved->next = nullptr;
+      REQUIRE(MyInt::AliveCount() == 1);
+      REQUIRE(arena.LiveCount() == 1);
+    }
+    REQUIRE(MyInt::AliveCount() == 0);
+    REQUIRE(arena.LiveCount() == 0);
+  }
+
+  // "Release"
+  {
+    CompressedArena arena(1 << 20);
+    CompressedUniquePtr<ListNode> node = MakeCompressedUnique<ListNode>(5);
+    ListNode *raw = node.Release();
+    REQUIRE(!node);
+    CompressedUniquePtr<ListNode> owner(raw);
+    REQUIRE(owner->value == 5);
+  }
+
+  // "Misuse is refused"
+  {
+    bool too_large = false;
+    try {
+      CompressedArena huge(CompressedArena::kMaxCapacity + 1);
+    } catch (const std::length_error &) {
+      too_large = true;
+    }
+    REQUIRE(too_large);
+
+    CompressedArena arena(1 << 20);
+    bool second = false;
+    try {
+      CompressedArena other(1 << 20);
+    } catch (const std::logic_error &) {
+      second = true;
+    }
+    REQUIRE(second);
+
+    ListNode outside(1);
+    bool foreign = false;
+    try {
+      CompressedUniquePtr<ListNode> owner(&outside);
+    } catch (const std::invalid_argument &) {
+      foreign = true;
+    }
+    REQUIRE(foreign);
+    REQUIRE(arena.LiveCount() == 0);
+  }
+}
@@ -0,0 +1,132 @@
+#include "../src/unique/compressed_pair.h"
+#include "../src/unique/compressed_tuple.h"
+#include "../src/unique/deleters.h"
+#include <memory>
+#include <string>
+
+#define REQUIRE(b)                                                             \
+  {                                                                            \
+    if (!(b)) {                                                                \
+      std::cout << "WRONG" << std::endl;                                       \
+    };                                                                         \
+  }
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct Empty {};
+struct OtherEmpty {};
+struct DerivedEmpty : Empty {};
+struct FinalEmpty final {};
+
+struct EmptyDeleter {
+  void operator()(int *ptr) const { delete ptr; }
+};
+
+// Size a tuple of `Ts...` must have if every empty non-final member is free.
+template <typename... Ts> constexpr size_t ExpectedSize() {
+  constexpr size_t payload =
+      ((std::is_empty_v<Ts> && !std::is_final_v<Ts> ? 0 : sizeof(void *)) +
+       ... + 0);
+  return payload == 0 ? 1 : payload;
+}
+
+template <typename A, typename B, typename C> constexpr bool CheckLayout() {
+  return sizeof(CompressedTuple<A, B, C>) == ExpectedSize<A, B, C>() &&
+         sizeof(CompressedTuple<A, B>) == ExpectedSize<A, B>() &&
+         sizeof(CompressedTuple<A>) == ExpectedSize<A>();
+}
+
+template <int I> struct Tag {};
+
+// Every slot is either a distinct empty type or a pointer: all 2^3 layouts.
+template <typename A, typename B> constexpr bool CheckLastSlot() {
+  return CheckLayout<A, B, Tag<2>>() && CheckLayout<A, B, int *>();
+}
+
+template <typename A> constexpr bool CheckMiddleSlot() {
+  return CheckLastSlot<A, Tag<1>>() && CheckLastSlot<A, int *>();
+}
+
+constexpr bool CheckAllLayouts() {
+  return CheckMiddleSlot<Tag<0>>() && CheckMiddleSlot<int *>();
+}
+
+void TestLayout() {
+  // "Every combination of empty and pointer members"
+  { static_assert(CheckAllLayouts()); }
+
+  // "Final members are stored by value"
+  {
+    static_assert(sizeof(CompressedTuple<int *, FinalEmpty>) ==
+                  2 * sizeof(int *));
+    static_assert(sizeof(CompressedTuple<FinalEmpty, Empty, int *>) ==
+                  2 * sizeof(int *));
+  }
+
+  // "Repeated and related empty types"
+  // Two subobjects of the same type need distinct addresses, so they are only
+  // free while they can share the address of a non-empty member.
+  {
+    static_assert(sizeof(CompressedTuple<Empty, Empty, int *>) ==
+                  sizeof(int *));
+    static_assert(sizeof(CompressedTuple<Empty, DerivedEmpty, int *>) ==
+                  sizeof(int *));
+  }
+
+  // "Pointer + deleter + allocator"
+  {
+    static_assert(sizeof(CompressedTuple<int *, EmptyDeleter,
+                                         std::allocator<int>>) ==
+                  sizeof(int *));
+    static_assert(sizeof(CompressedTuple<int *, std::default_delete<int>,
+                                         std::allocator<int>>) ==
+                  sizeof(int *));
+  }
+
+  // "Pair of empty types"
+  {
+    static_assert(sizeof(CompressedPair<Empty, OtherEmpty>) == 1);
+    static_assert(sizeof(CompressedPair<EmptyDeleter, std::allocator<int>>) ==
+                  1);
+  }
+}
+
+void TestAccess() {
+  // "Get"
+  {
+    CompressedTuple<int, Empty, std::string> t(1, Empty{}, "abc");
+    REQUIRE(t.Get<0>() == 1);
+    REQUIRE(t.Get<2>() == "abc");
+
+    t.Get<0>() = 2;
+    const auto &ct = t;
+    REQUIRE(ct.Get<0>() == 2);
+    static_assert(std::is_same_v<decltype(ct.Get<1>()), const Empty &>);
+  }
+
+  // "Move-only members"
+  {
+    CompressedTuple<std::unique_ptr<int>, Deleter<int>> t(
+        std::make_unique<int>(5), Deleter<int>(3));
+    CompressedTuple<std::unique_ptr<int>, Deleter<int>> moved(std::move(t));
+
+    REQUIRE(*moved.Get<0>() == 5);
+    REQUIRE(moved.Get<1>().GetTag() == 3);
+    REQUIRE(t.Get<1>().GetTag() == 0);
+  }
+
+  // "Copy of a single-member tuple"
+  {
+    CompressedTuple<std::string> a("abc");
+    CompressedTuple<std::string> b(a);
+    REQUIRE(b.Get<0>() == "abc");
+  }
+
+  // "Pair of empty types from rvalues"
+  {
+    CompressedPair<Empty, OtherEmpty> p(Empty{}, OtherEmpty{});
+    const auto &cp = p;
+    static_assert(std::is_same_v<decltype(cp.GetFirst()), const Empty &>);
+    static_assert(std::is_same_v<decltype(cp.GetSecond()), const OtherEmpty &>);
+  }
+}
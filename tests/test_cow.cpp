@@ -0,0 +1,135 @@
+#include "../src/shared/cow.h"
+#include "../src/weak/weak.h"
+#include "./my_int.h"
+#include <string>
+#include <vector>
+
+#define REQUIRE(b)                                                             \
+  {                                                                            \
+    if (!(b)) {                                                                \
+      std::cout << "WRONG" << std::endl;                                       \
+    };                                                                         \
+  }
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct Document {
+  std::vector<int> lines;
+  static inline int copies = 0;
+
+  Document() = default;
+  explicit Document(size_t size) : lines(size) {}
+  Document(const Document &other) : lines{other.lines} { ++copies; }
+  Document(Document &&) = default;
+};
+
+void TestCowPtr() {
+  // "Unique handle mutates in place"
+  {
+    CowPtr<Document> doc = MakeCow<Document>(10);
+    Document::copies = 0;
+    const Document *before = doc.Get();
+    doc.Mutate().lines[0] = 1;
+    doc.Mutate().lines[1] = 2;
+    REQUIRE(doc.Get() == before);
+    REQUIRE(Document::copies == 0);
+    REQUIRE(doc.Unique());
+  }
+
+  // "Shared handle clones once"
+  {
+    CowPtr<Document> doc = MakeCow<Document>(10);
+    CowPtr<Document> snapshot = doc;
+    REQUIRE(doc.UseCount() == 2);
+    Document::copies = 0;
+
+    doc.Mutate().lines[0] = 7;
+    doc.Mutate().lines[1] = 8;
+    REQUIRE(Document::copies == 1);
+    REQUIRE(doc->lines[0] == 7);
+    REQUIRE(snapshot->lines[0] == 0);
+    REQUIRE(doc.Unique());
+    REQUIRE(snapshot.Unique());
+  }
+
+  // "Shared read-only snapshots"
+  {
+    CowPtr<std::string> text(std::string("abc"));
+    SharedPtr<const std::string> view = text.Share();
+    text.Mutate() += "d";
+    REQUIRE(*view == "abc");
+    REQUIRE(*text == "abcd");
+    view.Reset();
+    const std::string *before = text.Get();
+    text.Mutate() += "e";
+    REQUIRE(text.Get() == before);
+  }
+
+  // "Weak reference to a dropped snapshot does not see edits"
+  {
+    CowPtr<std::string> text(std::string("abc"));
+    WeakPtr<const std::string> weak = text.Share();
+    REQUIRE(text.Unique());
+    text.Mutate() += "d";
+    REQUIRE(*text == "abcd");
+    SharedPtr<const std::string> locked = weak.Lock();
+    REQUIRE(weak.Expired() && !locked);
+  }
+
+  // "Release"
+  {
+    CowPtr<Document> doc = MakeCow<Document>(3);
+    Document::copies = 0;
+    UniquePtr<Document> owned = std::move(doc).Release();
+    REQUIRE(owned->lines.size() == 3);
+    REQUIRE(Document::copies == 0);
+
+    CowPtr<Document> shared = MakeCow<Document>(4);
+    CowPtr<Document> copy = shared;
+    UniquePtr<Document> cloned = std::move(shared).Release();
+    REQUIRE(cloned->lines.size() == 4);
+    REQUIRE(Document::copies == 1);
+    REQUIRE(copy->lines.size() == 4);
+    REQUIRE(copy.Unique());
+  }
+
+  // "Constructed in place"
+  {
+    CowPtr<MyInt> value = MakeCow<MyInt>(5);
+    REQUIRE(*value == 5);
+    REQUIRE(MyInt::AliveCount() == 1);
+    CowPtr<MyInt> copy = value;
+    copy.Mutate();
+    REQUIRE(MyInt::AliveCount() == 2);
+  }
+  REQUIRE(MyInt::AliveCount() == 0);
+}
+
+void TestTryUnwrap() {
+  // "Only owner"
+  {
+    SharedPtr<std::string> ptr = MakeShared<std::string>(100, 'x');
+    WeakPtr<std::string> weak = ptr;
+    UniquePtr<std::string> owned = TryUnwrap(std::move(ptr));
+    REQUIRE(owned);
+    REQUIRE(owned->size() == 100);
+    REQUIRE(!ptr);
+    REQUIRE(weak.Expired());
+  }
+
+  // "Shared object stays put"
+  {
+    SharedPtr<std::string> ptr = MakeShared<std::string>("abc");
+    SharedPtr<std::string> copy = ptr;
+    UniquePtr<std::string> owned = TryUnwrap(std::move(ptr));
+    REQUIRE(!owned);
+    REQUIRE(*ptr == "abc");
+    REQUIRE(ptr.UseCount() == 2);
+  }
+
+  // "Empty pointer"
+  {
+    SharedPtr<std::string> empty;
+    REQUIRE(!TryUnwrap(std::move(empty)));
+  }
+}
@@ -0,0 +1,158 @@
+#include "../src/intrusive/cycle_collector.h"
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#define REQUIRE(b)                                                             \
+  {                                                                            \
+    if (!(b)) {                                                                \
+      std::cout << "WRONG" << std::endl;                                       \
+    };                                                                         \
+  }
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct GcNode : Collectable {
+  GcNode() { ++alive; }
+  ~GcNode() override { --alive; }
+
+  void Trace(CycleTracer &tracer) override {
+    tracer(next);
+    tracer(other);
+  }
+
+  IntrusivePtr<GcNode> next;
+  IntrusivePtr<GcNode> other;
+
+  static inline int alive = 0;
+};
+
+void TestCycleCollector() {
+  CycleCollector &collector = CycleCollector::Local();
+
+  // "Acyclic objects are freed without the collector"
+  {
+    {
+      IntrusivePtr<GcNode> a = MakeIntrusive<GcNode>();
+      a->next = MakeIntrusive<GcNode>();
+    }
+    REQUIRE(GcNode::alive == 0);
+    REQUIRE(collector.CandidateCount() == 0);
+  }
+
+  // "Self cycle"
+  {
+    {
+      IntrusivePtr<GcNode> a = MakeIntrusive<GcNode>();
+      a->next = a;
+    }
+    REQUIRE(GcNode::alive == 1);
+    REQUIRE(collector.CandidateCount() == 1);
+    collector.CollectAll();
+    REQUIRE(GcNode::alive == 0);
+    REQUIRE(collector.CandidateCount() == 0);
+  }
+
+  // "Ring with a tail hanging off it"
+  {
+    {
+      IntrusivePtr<GcNode> head = MakeIntrusive<GcNode>();
+      IntrusivePtr<GcNode> node = head;
+      for (int i = 0; i < 9; ++i) {
+        node->next = MakeIntrusive<GcNode>();
+        node = node->next;
+      }
+      node->next = head;
+      head->other = MakeIntrusive<GcNode>();
+      head->other->next = MakeIntrusive<GcNode>();
+    }
+    REQUIRE(GcNode::alive == 12);
+    collector.CollectAll();
+    REQUIRE(GcNode::alive == 0);
+  }
+
+  // "Externally referenced cycles survive"
+  {
+    IntrusivePtr<GcNode> keep;
+    {
+      IntrusivePtr<GcNode> a = MakeIntrusive<GcNode>();
+      IntrusivePtr<GcNode> b = MakeIntrusive<GcNode>();
+      a->next = b;
+      b->next = a;
+      keep = b;
+    }
+    collector.CollectAll();
+    REQUIRE(GcNode::alive == 2);
+    REQUIRE(keep->next->next.Get() == keep.Get());
+
+    // Reachable from a survivor, but not referenced directly
+    IntrusivePtr<GcNode> holder = MakeIntrusive<GcNode>();
+    holder->other = keep;
+    keep.Reset();
+    collector.CollectAll();
+    REQUIRE(GcNode::alive == 3);
+
+    holder.Reset();
+    collector.CollectAll();
+    REQUIRE(GcNode::alive == 0);
+  }
+
+  // "Long cycle is scanned without recursion"
+  {
+    {
+      IntrusivePtr<GcNode> head = MakeIntrusive<GcNode>();
+      GcNode *tail = head.Get();
+      for (int i = 0; i < 1'000'000; ++i) {
+        tail->next = MakeIntrusive<GcNode>();
+        tail = tail->next.Get();
+      }
+      tail->next = head;
+    }
+    collector.CollectAll();
+    REQUIRE(GcNode::alive == 0);
+  }
+
+  // "Scan too long for the budget is abandoned"
+  {
+    {
+      IntrusivePtr<GcNode> head = MakeIntrusive<GcNode>();
+      GcNode *tail = head.Get();
+      for (int i = 0; i < 1'000'000; ++i) {
+        tail->next = MakeIntrusive<GcNode>();
+        tail = tail->next.Get();
+      }
+      tail->next = head;
+    }
+    size_t candidates = collector.CandidateCount();
+    size_t scanned = collector.GetStats().scanned;
+    auto start = std::chrono::steady_clock::now();
+    REQUIRE(!collector.Collect(std::chrono::microseconds(100)));
+    REQUIRE(std::chrono::steady_clock::now() - start <
+            std::chrono::milliseconds(50));
+    REQUIRE(collector.GetStats().abandoned > 0);
+    REQUIRE(collector.GetStats().scanned == scanned);
+    REQUIRE(collector.CandidateCount() == candidates);
+    REQUIRE(GcNode::alive == 1'000'001);
+    collector.CollectAll();
+    REQUIRE(GcNode::alive == 0);
+  }
+
+  // "Budgeted collection makes progress"
+  {
+    for (int i = 0; i < 10'000; ++i) {
+      IntrusivePtr<GcNode> a = MakeIntrusive<GcNode>();
+      a->next = MakeIntrusive<GcNode>();
+      a->next->next = a;
+    }
+    REQUIRE(GcNode::alive == 20'000);
+    REQUIRE(collector.CandidateCount() == 10'000);
+    REQUIRE(!collector.Collect(std::chrono::nanoseconds(0)));
+    REQUIRE(collector.CandidateCount() == 10'000 - CycleCollector::kBatchSize);
+    size_t collected = collector.GetStats().collected;
+    while (!collector.Collect(std::chrono::microseconds(100))) {
+    }
+    REQUIRE(GcNode::alive == 0);
+    REQUIRE(collector.GetStats().collected - collected ==
+            20'000 - 2 * CycleCollector::kBatchSize);
+  }
+}
@@ -0,0 +1,117 @@
+#include "../src/weak/expiry.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define REQUIRE(b)                                                             \
+  {                                                                            \
+    if (!(b)) {                                                                \
+      std::cout << "WRONG" << std::endl;                                       \
+    };                                                                         \
+  }
+
+////////////////////////////////////////////////////////////////////////////////
+
+void TestExpiryCallbacks() {
+  // "Blocks stay the same size"
+  { static_assert(sizeof(IBlock) == 3 * sizeof(void *)); }
+
+  // "Callback runs when the last SharedPtr goes away"
+  {
+    int calls = 0;
+    SharedPtr<std::string> a = MakeShared<std::string>("value");
+    SharedPtr<std::string> b = a;
+    WeakPtr<std::string> weak = a;
+    ExpirySubscription subscription = OnExpired(weak, [&] {
+      ++calls;
+      REQUIRE(weak.Expired());
+    });
+    REQUIRE(subscription);
+    REQUIRE(weak.UseCount() == 2);
+    a.Reset();
+    REQUIRE(calls == 0);
+    b.Reset();
+    REQUIRE(calls == 1);
+    REQUIRE(ExpiryRegistry::Global().ListenerCount() == 0);
+  }
+
+  // "Weak count is not disturbed by the listener mark"
+  {
+    SharedPtr<int> a = MakeShared<int>(1);
+    WeakPtr<int> w1 = a;
+    ExpirySubscription subscription = OnExpired(a, [] {});
+    WeakPtr<int> w2 = w1;
+    REQUIRE(a.UseCount() == 1);
+    w1.Reset();
+    a.Reset();
+    REQUIRE(w2.Expired());
+  }
+
+  // "Several listeners, cancellation"
+  {
+    std::vector<int> fired;
+    SharedPtr<int> a = MakeShared<int>(1);
+    ExpirySubscription first = OnExpired(a, [&] { fired.push_back(1); });
+    ExpirySubscription second = OnExpired(a, [&] { fired.push_back(2); });
+    ExpirySubscription third = OnExpired(a, [&] { fired.push_back(3); });
+    second.Cancel();
+    REQUIRE(!second);
+    REQUIRE(ExpiryRegistry::Global().ListenerCount() == 2);
+    {
+      ExpirySubscription moved = std::move(third);
+      REQUIRE(!third);
+    }
+    a.Reset();
+    REQUIRE(fired == std::vector<int>{1});
+    first.Cancel();
+  }
+
+  // "Released listener outlives its subscription"
+  {
+    int calls = 0;
+    SharedPtr<int> a = MakeShared<int>(1);
+    OnExpired(a, [&] { ++calls; }).Release();
+    a.Reset();
+    REQUIRE(calls == 1);
+  }
+
+  // "Expired or empty pointers give an empty subscription"
+  {
+    int calls = 0;
+    WeakPtr<int> weak;
+    REQUIRE(!OnExpired(weak, [&] { ++calls; }));
+    {
+      SharedPtr<int> a = MakeShared<int>(1);
+      weak = a;
+    }
+    REQUIRE(!OnExpired(weak, [&] { ++calls; }));
+    REQUIRE(calls == 0);
+  }
+
+  // "Index removes its entries in O(1)"
+  {
+    std::unordered_map<int, ExpirySubscription> index;
+    std::vector<SharedPtr<int>> objects;
+    for (int i = 0; i < 100; ++i) {
+      objects.push_back(MakeShared<int>(i));
+      index[i] = OnExpired(objects.back(), [&index, i] { index.erase(i); });
+    }
+    for (int i = 0; i < 100; i += 2) {
+      objects[i].Reset();
+    }
+    REQUIRE(index.size() == 50);
+    REQUIRE(index.count(0) == 0);
+    REQUIRE(index.count(1) == 1);
+    index.clear();
+    REQUIRE(ExpiryRegistry::Global().ListenerCount() == 0);
+  }
+
+  // "Listener of a custom deleter block"
+  {
+    int calls = 0;
+    SharedPtr<int> a(new int(5));
+    ExpirySubscription subscription = OnExpired(a, [&] { ++calls; });
+    a.Reset();
+    REQUIRE(calls == 1);
+  }
+}
@@ -0,0 +1,167 @@
+#include "../src/function/function.h"
+#include "../src/intrusive/intrusive.h"
+#include "../src/unique/unique.h"
+#include "./my_int.h"
+#include <string>
+
+#define REQUIRE(b)                                                             \
+  {                                                                            \
+    if (!(b)) {                                                                \
+      std::cout << "WRONG" << std::endl;                                       \
+    };                                                                         \
+  }
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct Counted : public SimpleRefCounted<Counted> {
+  int value = 0;
+};
+
+void TestEmpty() {
+  // "Default value"
+  {
+    UniqueFunction<int()> f;
+    REQUIRE(!f);
+    REQUIRE(f == nullptr);
+  }
+
+  // "Call of empty function throws"
+  {
+    UniqueFunction<void()> f;
+    bool thrown = false;
+    try {
+      f();
+    } catch (const BadFunctionCall &) {
+      thrown = true;
+    }
+    REQUIRE(thrown);
+  }
+
+  // "Null function pointer"
+  {
+    int (*fn)() = nullptr;
+    UniqueFunction<int()> f(fn);
+    REQUIRE(!f);
+  }
+
+  // "Null member pointer"
+  {
+    int Counted::*field = nullptr;
+    UniqueFunction<int(Counted &)> f(field);
+    REQUIRE(!f);
+  }
+}
+
+struct Getter {
+  int get() const { return value; }
+  void set(int v) { value = v; }
+  int value = 0;
+};
+
+void TestMemberPointers() {
+  // "Member functions and data members"
+  {
+    Getter getter;
+    UniqueFunction<void(Getter &, int)> set = &Getter::set;
+    UniqueFunction<int(const Getter &)> get = &Getter::get;
+    UniqueFunction<int(Getter *)> field = &Getter::value;
+    set(getter, 7);
+    REQUIRE(get(getter) == 7);
+    REQUIRE(field(&getter) == 7);
+  }
+
+  // "Result converted to R or discarded"
+  {
+    Getter getter{3};
+    UniqueFunction<long(const Getter &)> wide = &Getter::get;
+    UniqueFunction<void(const Getter &)> ignored = &Getter::get;
+    REQUIRE(wide(getter) == 3L);
+    ignored(getter);
+  }
+}
+
+void TestMoveOnlyCaptures() {
+  // "UniquePtr capture"
+  {
+    UniquePtr<MyInt> p(new MyInt(42));
+    UniqueFunction<bool()> f = [p = std::move(p)] { return *p == 42; };
+
+    static_assert(!std::is_copy_constructible_v<UniqueFunction<bool()>>);
+    REQUIRE(MyInt::AliveCount() == 1);
+    REQUIRE(f());
+
+    f = nullptr;
+    REQUIRE(MyInt::AliveCount() == 0);
+  }
+
+  // "IntrusivePtr capture"
+  {
+    IntrusivePtr<Counted> p(new Counted);
+    {
+      UniqueFunction<void(int)> f = [p](int v) { p->value += v; };
+      REQUIRE(p.UseCount() == 2);
+      f(5);
+      f(6);
+    }
+    REQUIRE(p.UseCount() == 1);
+    REQUIRE(p->value == 11);
+  }
+}
+
+void TestStorage() {
+  // "Inline and heap callables"
+  {
+    char big[256] = {};
+    big[255] = 7;
+    UniqueFunction<int(int)> small = [](int x) { return x + 1; };
+    UniqueFunction<int(int)> large = [big](int x) { return x + big[255]; };
+
+    REQUIRE(small(1) == 2);
+    REQUIRE(large(1) == 8);
+  }
+
+  // "Zero inline bytes still hold stateless callables"
+  {
+    UniqueFunction<int(), 0> f = [] { return 3; };
+    REQUIRE(sizeof(f) == 3 * sizeof(void *));
+    REQUIRE(f() == 3);
+  }
+}
+
+void TestMove() {
+  // "Move constructor"
+  {
+    UniquePtr<MyInt> p(new MyInt(1));
+    UniqueFunction<bool()> f = [p = std::move(p)] { return *p == 1; };
+    UniqueFunction<bool()> g(std::move(f));
+
+    REQUIRE(!f);
+    REQUIRE(g());
+    REQUIRE(MyInt::AliveCount() == 1);
+  }
+  REQUIRE(MyInt::AliveCount() == 0);
+
+  // "Move assignment destroys the old target"
+  {
+    UniqueFunction<void()> f = [p = UniquePtr<MyInt>(new MyInt)] {};
+    UniqueFunction<void()> g = [p = UniquePtr<MyInt>(new MyInt)] {};
+    REQUIRE(MyInt::AliveCount() == 2);
+
+    f = std::move(g);
+    REQUIRE(MyInt::AliveCount() == 1);
+    REQUIRE(f);
+    REQUIRE(!g);
+  }
+  REQUIRE(MyInt::AliveCount() == 0);
+
+  // "Swap"
+  {
+    std::string big(100, 'x');
+    UniqueFunction<std::string()> f = [] { return std::string("a"); };
+    UniqueFunction<std::string()> g = [big] { return big; };
+
+    f.Swap(g);
+    REQUIRE(f() == big);
+    REQUIRE(g() == "a");
+  }
+}
@@ -0,0 +1,87 @@
+#include "../src/unique/huge_pages.h"
+#include "../src/unique/unique_array.h"
+#include "./my_int.h"
+
+#define REQUIRE(b)                                                             \
+  {                                                                            \
+    if (!(b)) {                                                                \
+      std::cout << "WRONG" << std::endl;                                       \
+    };                                                                         \
+  }
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool IsHugeAligned(const void *ptr) {
+  return reinterpret_cast<uintptr_t>(ptr) % kHugePageSize == 0;
+}
+
+void TestMapHugePages() {
+  // "Length"
+  {
+    REQUIRE(HugePagesLength(1) == kHugePageSize);
+    REQUIRE(HugePagesLength(kHugePageSize) == kHugePageSize);
+    REQUIRE(HugePagesLength(kHugePageSize + 1) == 2 * kHugePageSize);
+  }
+
+  // "Aligned and zeroed"
+  {
+    size_t bytes = 3 * kHugePageSize + 5;
+    auto *ptr = static_cast<char *>(MapHugePages(bytes));
+    REQUIRE(IsHugeAligned(ptr));
+    REQUIRE(ptr[0] == 0 && ptr[bytes - 1] == 0);
+    UnmapHugePages(ptr, bytes);
+  }
+
+  // "Empty"
+  { REQUIRE(MapHugePages(0) == nullptr); }
+}
+
+void TestHugeArrays() {
+  // "UniquePtr"
+  {
+    UniqueHugePtr<double> a = MakeUniqueHuge<double>(1 << 20);
+    REQUIRE(IsHugeAligned(a.Get()));
+    REQUIRE(a.GetDeleter().Size() == 1 << 20);
+    a[12345] = 1.5;
+    REQUIRE(a[12345] == 1.5 && a[0] == 0.0);
+  }
+
+  // "SharedPtr"
+  {
+    SharedPtr<int> alias;
+    {
+      SharedPtr<int[]> a = MakeSharedHuge<int>(1000);
+      a[999] = 7;
+      alias = SharedPtr<int>(a, a.Get() + 999);
+    }
+    REQUIRE(*alias == 7);
+  }
+
+  // "Non-trivial elements are constructed and destroyed"
+  {
+    { UniqueHugePtr<MyInt> a = MakeUniqueHuge<MyInt>(10); }
+    REQUIRE(MyInt::AliveCount() == 0);
+
+    SharedPtr<MyInt[]> b = MakeSharedHuge<MyInt>(10);
+    REQUIRE(MyInt::AliveCount() == 10);
+    b.Reset();
+    REQUIRE(MyInt::AliveCount() == 0);
+  }
+
+  // "UniqueArray with huge page alignment"
+  {
+    UniqueArray<float, kHugePageSize> a(3 << 20, 2.f);
+    REQUIRE(IsHugeAligned(a.Data()));
+    REQUIRE(a[(3 << 20) - 1] == 2.f);
+  }
+
+  // "UniqueArray aligned beyond a huge page"
+  {
+    constexpr size_t kAlign = 4 << 20;
+    for (int i = 0; i < 8; ++i) {
+      UniqueArray<char, kAlign> a(kHugePageSize + 1);
+      REQUIRE(reinterpret_cast<uintptr_t>(a.Data()) % kAlign == 0);
+      a[kHugePageSize] = 1;
+    }
+  }
+}
@@ -0,0 +1,135 @@
+#include "../src/shared/interner.h"
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define REQUIRE(b)                                                             \
+  {                                                                            \
+    if (!(b)) {                                                                \
+      std::cout << "WRONG" << std::endl;                                       \
+    };                                                                         \
+  }
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Sends every key to the same shard and slot chain
+struct ConstantHash {
+  size_t operator()(int) const { return 42; }
+};
+
+void TestInterner() {
+  // "Equal values share one instance"
+  {
+    Interner<std::string> interner;
+    SharedPtr<const std::string> a = interner.Intern(std::string("schema"));
+    std::string copy = "schema";
+    SharedPtr<const std::string> b = interner.Intern(copy);
+    SharedPtr<const std::string> c = interner.Intern(std::string("other"));
+    REQUIRE(a.Get() == b.Get());
+    REQUIRE(a.Get() != c.Get());
+    REQUIRE(*a == "schema");
+    REQUIRE(a.UseCount() == 2);
+    REQUIRE(interner.EntryCount() == 2);
+  }
+
+  // "The table does not keep values alive"
+  {
+    Interner<std::string> interner;
+    SharedPtr<const std::string> a = interner.Intern(std::string("x"));
+    WeakPtr<const std::string> observer(a);
+    a.Reset();
+    REQUIRE(observer.Expired());
+
+    SharedPtr<const std::string> again = interner.Intern(std::string("x"));
+    REQUIRE(*again == "x");
+    REQUIRE(again.UseCount() == 1);
+    REQUIRE(interner.EntryCount() == 1);
+  }
+
+  // "Expired entries are purged while probing"
+  {
+    Interner<int, ConstantHash> interner;
+    std::vector<SharedPtr<const int>> kept;
+    for (int i = 0; i < 10; ++i) {
+      kept.push_back(interner.Intern(i));
+    }
+    for (int i = 9; i > 0; i -= 2) {
+      kept.erase(kept.begin() + i);
+    }
+    REQUIRE(interner.EntryCount() == 10);
+    // The probe for a new key walks over the whole chain
+    SharedPtr<const int> fresh = interner.Intern(100);
+    REQUIRE(interner.EntryCount() == 6);
+    for (int i = 0; i < 10; i += 2) {
+      REQUIRE(interner.Intern(i).Get() == kept[i / 2].Get());
+    }
+    kept.clear();
+    fresh.Reset();
+    interner.Purge();
+    REQUIRE(interner.EntryCount() == 0);
+  }
+
+  // "Many values, many expirations"
+  {
+    Interner<int> interner;
+    std::vector<SharedPtr<const int>> kept;
+    for (int round = 0; round < 10; ++round) {
+      for (int i = 0; i < 10'000; ++i) {
+        SharedPtr<const int> value = interner.Intern(i);
+        if (i % 100 == 0 && round == 0) {
+          kept.push_back(value);
+        }
+      }
+    }
+    for (int i = 0; i < 10'000; i += 100) {
+      REQUIRE(interner.Intern(i).Get() == kept[i / 100].Get());
+    }
+    interner.Purge();
+    REQUIRE(interner.EntryCount() == kept.size());
+  }
+
+  // "Concurrent interning"
+  {
+    Interner<std::string> interner;
+    const int threads = 4;
+    std::vector<std::vector<SharedPtr<const std::string>>> results(threads);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+      workers.emplace_back([&interner, &results, t] {
+        for (int i = 0; i < 2000; ++i) {
+          results[t].push_back(
+              interner.Intern(std::to_string(t) + ":" + std::to_string(i)));
+        }
+      });
+    }
+    for (auto &worker : workers) {
+      worker.join();
+    }
+    REQUIRE(interner.EntryCount() == threads * 2000);
+    for (int t = 0; t < threads; ++t) {
+      REQUIRE(interner.Intern(std::to_string(t) + ":7").Get() ==
+              results[t][7].Get());
+    }
+  }
+
+  // "Shared values die while other threads intern them"
+  {
+    Interner<int> interner;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; ++t) {
+      workers.emplace_back([&interner] {
+        for (int i = 0; i < 20'000; ++i) {
+          SharedPtr<const int> value = interner.Intern(i % 64);
+          SharedPtr<const int> copy = value;
+          REQUIRE(*copy == i % 64);
+        }
+      });
+    }
+    for (auto &worker : workers) {
+      worker.join();
+    }
+    interner.Purge();
+    REQUIRE(interner.EntryCount() == 0);
+  }
+}
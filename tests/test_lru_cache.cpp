@@ -0,0 +1,146 @@
+#include "../src/shared/lru_cache.h"
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define REQUIRE(b)                                                             \
+  {                                                                            \
+    if (!(b)) {                                                                \
+      std::cout << "WRONG" << std::endl;                                       \
+    };                                                                         \
+  }
+
+////////////////////////////////////////////////////////////////////////////////
+
+void TestSharedLruCache() {
+  // "Put and get"
+  {
+    SharedLruCache<int, std::string> cache(1000, 1);
+    cache.Put(1, MakeShared<std::string>("one"), 10);
+    cache.Put(2, MakeShared<std::string>("two"), 10);
+    REQUIRE(*cache.Get(1) == "one");
+    REQUIRE(*cache.Get(2) == "two");
+    REQUIRE(!cache.Get(3));
+    REQUIRE(cache.Size() == 2);
+    REQUIRE(cache.Weight() == 20);
+
+    cache.Put(1, MakeShared<std::string>("uno"), 15);
+    REQUIRE(*cache.Get(1) == "uno");
+    REQUIRE(cache.Weight() == 25);
+
+    auto stats = cache.GetStats();
+    REQUIRE(stats.hits == 3);
+    REQUIRE(stats.misses == 1);
+  }
+
+  // "Capacity is measured in bytes"
+  {
+    SharedLruCache<int, int> cache(100, 1);
+    for (int i = 0; i < 10; ++i) {
+      cache.Put(i, MakeShared<int>(i), 30);
+    }
+    REQUIRE(cache.Weight() <= 100);
+    REQUIRE(cache.Size() == 3);
+    REQUIRE(cache.GetStats().evictions == 7);
+  }
+
+  // "Referenced entries get a second chance"
+  {
+    SharedLruCache<int, int> cache(3, 1);
+    cache.Put(1, MakeShared<int>(1), 1);
+    cache.Put(2, MakeShared<int>(2), 1);
+    cache.Put(3, MakeShared<int>(3), 1);
+    cache.Get(1);
+    cache.Put(4, MakeShared<int>(4), 1);
+    REQUIRE(cache.Get(1));
+    REQUIRE(!cache.Get(2));
+    REQUIRE(cache.Size() == 3);
+  }
+
+  // "Evicted values stay valid for holders and come back"
+  {
+    SharedLruCache<int, std::string> cache(1, 1);
+    cache.Put(1, MakeShared<std::string>("held"), 1);
+    SharedPtr<std::string> held = cache.Get(1);
+    cache.Put(2, MakeShared<std::string>("other"), 1);
+    cache.Put(3, MakeShared<std::string>("third"), 1);
+    REQUIRE(*held == "held");
+    REQUIRE(cache.Size() == 1);
+
+    SharedPtr<std::string> again = cache.Get(1);
+    REQUIRE(again.Get() == held.Get());
+    REQUIRE(cache.GetStats().resurrections == 1);
+    REQUIRE(cache.Size() == 1);
+
+    // Nobody holds the value of 2 any more
+    REQUIRE(!cache.Get(2));
+  }
+
+  // "Erase"
+  {
+    SharedLruCache<int, int> cache(1, 1);
+    SharedPtr<int> held = MakeShared<int>(1);
+    cache.Put(1, held, 1);
+    cache.Put(2, MakeShared<int>(2), 1);
+    REQUIRE(cache.Size() == 1);
+    REQUIRE(cache.Erase(1));
+    REQUIRE(!cache.Get(1));
+    REQUIRE(cache.Erase(2));
+    REQUIRE(!cache.Erase(2));
+    REQUIRE(cache.Size() == 0);
+    REQUIRE(*held == 1);
+  }
+
+  // "The side index does not grow without bound"
+  {
+    SharedLruCache<int, int> cache(10, 1);
+    std::vector<SharedPtr<int>> held;
+    for (int i = 0; i < 10'000; ++i) {
+      cache.Put(i, MakeShared<int>(i), 1);
+      if (i % 1000 == 0) {
+        held.push_back(cache.Get(i));
+      }
+    }
+    for (int i = 0; i < 10'000; i += 1000) {
+      REQUIRE(*cache.Get(i) == i);
+    }
+  }
+
+  // "No shards means one"
+  {
+    SharedLruCache<int, int> cache(2, 0);
+    cache.Put(1, MakeShared<int>(1), 1);
+    cache.Put(2, MakeShared<int>(2), 1);
+    REQUIRE(cache.Size() == 2);
+    REQUIRE(*cache.Get(1) == 1);
+  }
+
+  // "Threads share values while they are evicted"
+  {
+    SharedLruCache<int, int> cache(16, 2);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; ++t) {
+      workers.emplace_back([&cache, t] {
+        std::vector<SharedPtr<int>> held;
+        for (int i = 0; i < 20'000; ++i) {
+          int key = (i * 7 + t) % 64;
+          SharedPtr<int> value = cache.Get(key);
+          if (!value) {
+            value = MakeShared<int>(key);
+            cache.Put(key, value, 1);
+          }
+          REQUIRE(*value == key);
+          held.push_back(value);
+          if (held.size() > 8) {
+            held.erase(held.begin());
+          }
+        }
+      });
+    }
+    for (auto &worker : workers) {
+      worker.join();
+    }
+    REQUIRE(cache.Weight() <= 16);
+  }
+}
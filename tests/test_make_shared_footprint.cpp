@@ -0,0 +1,157 @@
+#include "../src/shared/shared.h"
+#include "../src/weak/weak.h"
+#include <cstdlib>
+#include <limits>
+#include <new>
+
+#define REQUIRE(b)                                                             \
+  {                                                                            \
+    if (!(b)) {                                                                \
+      std::cout << "WRONG" << std::endl;                                       \
+    };                                                                         \
+  }
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Heap accounting: every allocation is prefixed with its size
+static size_t live_bytes = 0;
+static size_t allocations = 0;
+
+void *operator new(size_t size) {
+  auto *header =
+      static_cast<std::max_align_t *>(std::malloc(size + sizeof(std::max_align_t)));
+  if (header == nullptr) {
+    throw std::bad_alloc();
+  }
+  *reinterpret_cast<size_t *>(header) = size;
+  live_bytes += size;
+  ++allocations;
+  return header + 1;
+}
+
+void operator delete(void *ptr) noexcept {
+  if (ptr == nullptr) {
+    return;
+  }
+  auto *header = static_cast<std::max_align_t *>(ptr) - 1;
+  live_bytes -= *reinterpret_cast<size_t *>(header);
+  std::free(header);
+}
+
+void operator delete(void *ptr, size_t) noexcept { operator delete(ptr); }
+
+struct Small {
+  int value = 0;
+};
+
+struct Large {
+  char payload[1 << 20];
+};
+
+struct Forced {
+  int value = 0;
+};
+
+template <> struct SplitMakeSharedPayload<Forced> : std::true_type {};
+
+// The 5000th element fails to construct
+struct ThrowsMidArray {
+  ThrowsMidArray() {
+    if (++made == 5000) {
+      throw 1;
+    }
+  }
+  static inline int made = 0;
+  char data[16];
+};
+
+void TestFootprint() {
+  // "Small objects stay in one allocation"
+  {
+    size_t before = allocations;
+    SharedPtr<Small> p = MakeShared<Small>();
+    REQUIRE(allocations - before == 1);
+  }
+
+  // "Expired large payload is freed while weak references live"
+  {
+    size_t before = live_bytes;
+    SharedPtr<Large> p = MakeShared<Large>();
+    WeakPtr<Large> w = p;
+    REQUIRE(live_bytes - before >= sizeof(Large));
+
+    p.Reset();
+    REQUIRE(w.Expired());
+    REQUIRE(live_bytes - before < 1024);
+
+    w.Reset();
+    REQUIRE(live_bytes == before);
+  }
+
+  // "Small arrays stay in one allocation"
+  {
+    size_t before = allocations;
+    SharedPtr<int[]> p = MakeShared<int[]>(16);
+    REQUIRE(allocations - before == 1);
+    REQUIRE(p[15] == 0);
+  }
+
+  // "Expired large array is freed while weak references live"
+  {
+    size_t before = live_bytes;
+    SharedPtr<char[]> p = MakeShared<char[]>(1 << 20, 'x');
+    WeakPtr<char[]> w = p;
+    REQUIRE(live_bytes - before >= (1 << 20));
+    REQUIRE(p[(1 << 20) - 1] == 'x');
+
+    p.Reset();
+    REQUIRE(w.Expired());
+    REQUIRE(live_bytes - before < 1024);
+
+    w.Reset();
+    REQUIRE(live_bytes == before);
+  }
+
+  // "Large array whose element throws leaks nothing"
+  {
+    size_t before = live_bytes;
+    bool thrown = false;
+    try {
+      MakeShared<ThrowsMidArray[]>(10000);
+    } catch (int) {
+      thrown = true;
+    }
+    REQUIRE(thrown);
+    REQUIRE(live_bytes == before);
+  }
+
+  // "Array length overflowing the allocation size throws"
+  {
+    size_t before = allocations;
+    bool thrown = false;
+    try {
+      MakeShared<int[]>(std::numeric_limits<size_t>::max() / 2);
+    } catch (const std::bad_array_new_length &) {
+      thrown = true;
+    }
+    REQUIRE(thrown);
+    REQUIRE(allocations == before);
+  }
+
+  // "Split can be forced per type"
+  {
+    size_t before = allocations;
+    SharedPtr<Forced> p = MakeShared<Forced>(Forced{5});
+    REQUIRE(allocations - before == 2);
+    REQUIRE(p->value == 5);
+  }
+
+  // "Over-aligned payload"
+  {
+    struct alignas(64) Wide {
+      char data[64];
+    };
+    SharedPtr<Wide> p = MakeShared<Wide>();
+    REQUIRE(reinterpret_cast<uintptr_t>(p.Get()) % 64 == 0);
+  }
+}
@@ -0,0 +1,78 @@
+#include "../src/shared/map_shared.h"
+#include <cstdio>
+#include <string_view>
+
+#define REQUIRE(b)                                                             \
+  {                                                                            \
+    if (!(b)) {                                                                \
+      std::cout << "WRONG" << std::endl;                                       \
+    };                                                                         \
+  }
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::string WriteTempFile(std::string_view content) {
+  char path[] = "/tmp/map_shared_XXXXXX";
+  int fd = mkstemp(path);
+  if (write(fd, content.data(), content.size()) !=
+      static_cast<ssize_t>(content.size())) {
+    std::cout << "WRONG" << std::endl;
+  }
+  close(fd);
+  return path;
+}
+
+std::string_view AsString(const SharedBytes &bytes) {
+  return {reinterpret_cast<const char *>(bytes.Data()), bytes.Size()};
+}
+
+void TestMapShared() {
+  // "Content"
+  {
+    std::string path = WriteTempFile("mapped file content");
+    SharedBytes bytes = MapShared(path);
+    REQUIRE(AsString(bytes) == "mapped file content");
+    REQUIRE(bytes.UseCount() == 1);
+    std::remove(path.c_str());
+  }
+
+  // "Slice keeps the mapping alive"
+  {
+    std::string path = WriteTempFile("header|body");
+    SharedBytes body;
+    {
+      SharedBytes bytes = MapShared(path, {.advice = MapAdvice::kRandom});
+      body = bytes.Subspan(7);
+    }
+    std::remove(path.c_str());
+    REQUIRE(AsString(body) == "body");
+  }
+
+  // "Populate and advise"
+  {
+    std::string path = WriteTempFile(std::string(10000, 'x'));
+    SharedBytes bytes = MapShared(path, {.populate = true});
+    AdviseMapped(bytes.Subspan(5000, 100), MapAdvice::kWillNeed);
+    REQUIRE(bytes.Size() == 10000);
+    REQUIRE(bytes[9999] == std::byte{'x'});
+    std::remove(path.c_str());
+  }
+
+  // "Empty file"
+  {
+    std::string path = WriteTempFile("");
+    REQUIRE(MapShared(path).Empty());
+    std::remove(path.c_str());
+  }
+
+  // "Missing file"
+  {
+    bool thrown = false;
+    try {
+      MapShared("/nonexistent/file");
+    } catch (const std::system_error &e) {
+      thrown = e.code() == std::errc::no_such_file_or_directory;
+    }
+    REQUIRE(thrown);
+  }
+}
@@ -0,0 +1,230 @@
+#include "../src/persistent/persistent_map.h"
+#include "../src/persistent/persistent_vector.h"
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#define REQUIRE(b)                                                             \
+  {                                                                            \
+    if (!(b)) {                                                                \
+      std::cout << "WRONG" << std::endl;                                       \
+    };                                                                         \
+  }
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename T> bool Equals(const PersistentVector<T> &v, size_t size) {
+  if (v.Size() != size) {
+    return false;
+  }
+  bool ok = true;
+  size_t i = 0;
+  v.ForEach([&](const T &value) { ok = ok && value == T(i++); });
+  for (size_t j = 0; j < size; ++j) {
+    ok = ok && v[j] == T(j);
+  }
+  return ok && i == size;
+}
+
+// Every key lands in one of four buckets, so deep paths and collision nodes
+// get exercised
+struct BadHash {
+  size_t operator()(int key) const { return key % 4; }
+};
+
+void TestPersistentVector() {
+  // "Push and read back across several trie levels"
+  {
+    PersistentVector<size_t> v;
+    REQUIRE(v.Empty());
+    for (size_t i = 0; i < 100'000; ++i) {
+      v.PushBack(i);
+    }
+    REQUIRE(Equals(v, 100'000));
+    REQUIRE(v.Back() == 99'999);
+  }
+
+  // "Snapshots do not see later edits"
+  {
+    PersistentVector<size_t> v;
+    for (size_t i = 0; i < 2000; ++i) {
+      v.PushBack(i);
+    }
+    PersistentVector<size_t> snapshot = v;
+    v.Set(0, 100);
+    v.Set(1999, 100);
+    v.PushBack(2000);
+    REQUIRE(Equals(snapshot, 2000));
+    REQUIRE(v[0] == 100);
+    REQUIRE(v[1999] == 100);
+    REQUIRE(v[1000] == 1000);
+    REQUIRE(v.Size() == 2001);
+
+    v.Set(0, 0);
+    v.Set(1999, 1999);
+    REQUIRE(Equals(v, 2001));
+  }
+
+  // "Pop back across leaf and level boundaries"
+  {
+    PersistentVector<size_t> v;
+    const size_t size = 32 * 32 + 32 + 3;
+    for (size_t i = 0; i < size; ++i) {
+      v.PushBack(i);
+    }
+    std::vector<PersistentVector<size_t>> snapshots;
+    for (size_t n = size; n > 0; --n) {
+      REQUIRE(Equals(v, n));
+      if (n % 97 == 0) {
+        snapshots.push_back(v);
+      }
+      v.PopBack();
+    }
+    REQUIRE(v.Empty());
+    for (const auto &snapshot : snapshots) {
+      REQUIRE(snapshot.Size() % 97 == 0);
+      REQUIRE(Equals(snapshot, snapshot.Size()));
+    }
+    for (size_t i = 0; i < size; ++i) {
+      v.PushBack(i);
+    }
+    REQUIRE(Equals(v, size));
+  }
+
+  // "Unshared vector edits in place"
+  {
+    PersistentVector<std::string> v;
+    for (int i = 0; i < 100; ++i) {
+      v.PushBack(std::to_string(i));
+    }
+    const std::string *before = &v[10];
+    v.Set(10, "ten");
+    REQUIRE(&v[10] == before);
+
+    PersistentVector<std::string> snapshot = v;
+    v.Set(10, "TEN");
+    REQUIRE(&v[10] != before);
+    REQUIRE(&snapshot[10] == before);
+    REQUIRE(snapshot[10] == "ten");
+    REQUIRE(v[10] == "TEN");
+  }
+
+  // "Clear and swap"
+  {
+    PersistentVector<size_t> a;
+    PersistentVector<size_t> b;
+    for (size_t i = 0; i < 50; ++i) {
+      a.PushBack(i);
+    }
+    a.Swap(b);
+    REQUIRE(a.Empty());
+    REQUIRE(Equals(b, 50));
+    b.Clear();
+    REQUIRE(b.Empty());
+  }
+}
+
+void TestPersistentMap() {
+  // "Set, find and overwrite"
+  {
+    PersistentMap<std::string, int> map;
+    REQUIRE(map.Set("a", 1));
+    REQUIRE(map.Set("b", 2));
+    REQUIRE(!map.Set("a", 3));
+    REQUIRE(map.Size() == 2);
+    REQUIRE(*map.Find("a") == 3);
+    REQUIRE(*map.Find("b") == 2);
+    REQUIRE(map.Find("c") == nullptr);
+    REQUIRE(!map.Contains("c"));
+  }
+
+  // "Agrees with std::map on many keys"
+  {
+    PersistentMap<int, int> map;
+    std::map<int, int> expected;
+    for (int i = 0; i < 20'000; ++i) {
+      int key = (i * 7919) % 10'007;
+      REQUIRE(map.Set(key, i) == expected.insert_or_assign(key, i).second);
+    }
+    for (int i = 0; i < 10'007; i += 3) {
+      REQUIRE(map.Erase(i) == (expected.erase(i) == 1));
+    }
+    REQUIRE(map.Size() == expected.size());
+    size_t visited = 0;
+    map.ForEach([&](int key, int value) {
+      ++visited;
+      REQUIRE(expected.at(key) == value);
+    });
+    REQUIRE(visited == expected.size());
+  }
+
+  // "Snapshots do not see later edits"
+  {
+    PersistentMap<int, std::string> map;
+    for (int i = 0; i < 1000; ++i) {
+      map.Set(i, std::to_string(i));
+    }
+    PersistentMap<int, std::string> snapshot = map;
+    for (int i = 0; i < 1000; i += 2) {
+      map.Erase(i);
+    }
+    map.Set(1, "one");
+    map.Set(5000, "new");
+    REQUIRE(snapshot.Size() == 1000);
+    for (int i = 0; i < 1000; ++i) {
+      REQUIRE(*snapshot.Find(i) == std::to_string(i));
+    }
+    REQUIRE(!snapshot.Contains(5000));
+    REQUIRE(map.Size() == 501);
+    REQUIRE(*map.Find(1) == "one");
+    REQUIRE(!map.Contains(2));
+  }
+
+  // "Colliding hashes"
+  {
+    PersistentMap<int, int, BadHash> map;
+    for (int i = 0; i < 100; ++i) {
+      REQUIRE(map.Set(i, -i));
+    }
+    PersistentMap<int, int, BadHash> snapshot = map;
+    for (int i = 0; i < 100; ++i) {
+      REQUIRE(*map.Find(i) == -i);
+    }
+    for (int i = 0; i < 100; ++i) {
+      if (i % 10 != 0) {
+        REQUIRE(map.Erase(i));
+      }
+    }
+    REQUIRE(!map.Erase(1));
+    REQUIRE(map.Size() == 10);
+    for (int i = 0; i < 100; ++i) {
+      REQUIRE(map.Contains(i) == (i % 10 == 0));
+      REQUIRE(*snapshot.Find(i) == -i);
+    }
+    for (int i = 0; i < 100; i += 10) {
+      REQUIRE(map.Erase(i));
+    }
+    REQUIRE(map.Empty());
+    REQUIRE(snapshot.Size() == 100);
+  }
+}
+
+void TestNodePool() {
+  // "Freed nodes are reused"
+  {
+    struct Node : SimpleRefCounted<Node, PooledDelete> {
+      int value = 0;
+    };
+    const Node *first = nullptr;
+    {
+      IntrusivePtr<Node> node = MakePooled<Node>();
+      first = node.Get();
+    }
+    size_t free = NodePool<Node>::Local().FreeCount();
+    REQUIRE(free >= 1);
+    IntrusivePtr<Node> node = MakePooled<Node>();
+    REQUIRE(node.Get() == first);
+    REQUIRE(NodePool<Node>::Local().FreeCount() == free - 1);
+  }
+}
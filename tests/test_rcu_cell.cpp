@@ -0,0 +1,112 @@
+#include "../src/shared/rcu_cell.h"
+#include <atomic>
+#include <iostream>
+#include <latch>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#define REQUIRE(b)                                                             \
+  {                                                                            \
+    if (!(b)) {                                                                \
+      std::cout << "WRONG" << std::endl;                                       \
+    };                                                                         \
+  }
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct Config {
+  Config(int version) : version{version}, doubled{2 * version} { ++alive; }
+  ~Config() {
+    // Poison the object, so a reader of a released snapshot notices
+    doubled = -1;
+    --alive;
+  }
+
+  int version;
+  int doubled;
+  static inline std::atomic<int> alive = 0;
+};
+
+void TestRcuCell() {
+  // "Readers see the current snapshot"
+  {
+    RcuCell<Config> cell(MakeShared<Config>(1));
+    {
+      auto config = cell.Read();
+      REQUIRE(config->version == 1);
+      REQUIRE((*config).doubled == 2);
+    }
+    cell.Emplace(2);
+    REQUIRE(cell.Read()->version == 2);
+    REQUIRE(Config::alive == 1);
+  }
+  REQUIRE(Config::alive == 0);
+
+  // "Nested read sections"
+  {
+    RcuCell<std::string> cell(MakeShared<std::string>("a"));
+    auto outer = cell.Read();
+    {
+      auto inner = cell.Read();
+      REQUIRE(*inner == "a");
+    }
+    REQUIRE(*outer == "a");
+  }
+
+  // "Published snapshot is co-owned"
+  {
+    SharedPtr<const Config> snapshot = MakeShared<Config>(3);
+    RcuCell<Config> cell(snapshot);
+    REQUIRE(snapshot.UseCount() == 2);
+    cell.Emplace(4);
+    REQUIRE(snapshot.UseCount() == 1);
+    REQUIRE(snapshot->version == 3);
+  }
+  REQUIRE(Config::alive == 0);
+}
+
+void TestRcuCellThreads() {
+  // "Old snapshots outlive their readers"
+  {
+    RcuCell<Config> cell(MakeShared<Config>(0));
+    std::atomic<bool> stop = false;
+    std::atomic<size_t> errors = 0;
+    std::atomic<size_t> reads = 0;
+    // Publishing starts once every reader has read, however the threads get scheduled
+    std::latch started(4);
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+      readers.emplace_back([&] {
+        int last = 0;
+        bool first = true;
+        while (!stop.load()) {
+          auto config = cell.Read();
+          if (config->doubled != 2 * config->version || config->version < last) {
+            ++errors;
+          }
+          last = config->version;
+          ++reads;
+          if (std::exchange(first, false)) {
+            started.count_down();
+          }
+        }
+      });
+    }
+    started.wait();
+    for (int version = 1; version <= 200; ++version) {
+      cell.Emplace(version);
+    }
+    stop = true;
+    for (auto &reader : readers) {
+      reader.join();
+    }
+    REQUIRE(errors == 0);
+    REQUIRE(reads >= 4);
+    REQUIRE(cell.Read()->version == 200);
+    REQUIRE(Config::alive == 1);
+  }
+  REQUIRE(Config::alive == 0);
+}
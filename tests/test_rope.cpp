@@ -0,0 +1,139 @@
+#include "../src/persistent/rope.h"
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#define REQUIRE(b)                                                             \
+  {                                                                            \
+    if (!(b)) {                                                                \
+      std::cout << "WRONG" << std::endl;                                       \
+    };                                                                         \
+  }
+
+////////////////////////////////////////////////////////////////////////////////
+
+// log2(n) * 1.44 is the AVL bound on the height, leaves hold at least one char
+bool Balanced(const Rope &rope) {
+  size_t bound = 2;
+  for (size_t n = rope.Size(); n > 1; n /= 2) {
+    bound += 2;
+  }
+  return rope.Height() <= bound;
+}
+
+void TestRope() {
+  // "Build and read back"
+  {
+    std::string text(10'000, ' ');
+    for (size_t i = 0; i < text.size(); ++i) {
+      text[i] = 'a' + i % 26;
+    }
+    Rope rope(text);
+    REQUIRE(rope.Size() == text.size());
+    REQUIRE(rope.ToString() == text);
+    REQUIRE(rope[0] == 'a');
+    REQUIRE(rope[9999] == text[9999]);
+    REQUIRE(Balanced(rope));
+    REQUIRE(Rope().Empty());
+    REQUIRE(Rope().ToString().empty());
+  }
+
+  // "Insert, erase and substring"
+  {
+    Rope rope("hello world");
+    rope.Insert(5, ",");
+    rope.Insert(rope.Size(), "!");
+    rope.Insert(0, ">> ");
+    REQUIRE(rope.ToString() == ">> hello, world!");
+    rope.Erase(0, 3);
+    REQUIRE(rope.ToString() == "hello, world!");
+    rope.Erase(5, 100);
+    REQUIRE(rope.ToString() == "hello");
+    REQUIRE(rope.Substr(1, 3).ToString() == "ell");
+    REQUIRE(rope.Substr(2, 100).ToString() == "llo");
+    REQUIRE(rope.Substr(5, 1).Empty());
+  }
+
+  // "Concatenation"
+  {
+    Rope a("abc");
+    Rope b(std::string(5000, 'x'));
+    Rope c = a + b + a;
+    REQUIRE(c.Size() == 5006);
+    REQUIRE(c.ToString() == "abc" + std::string(5000, 'x') + "abc");
+    a.Append(b);
+    a.Append("def");
+    REQUIRE(a.ToString() == "abc" + std::string(5000, 'x') + "def");
+  }
+
+  // "Old versions stay unchanged"
+  {
+    Rope rope(std::string(3000, 'a'));
+    Rope before = rope;
+    rope.Insert(1500, "bbb");
+    rope.Erase(0, 10);
+    REQUIRE(before.ToString() == std::string(3000, 'a'));
+    REQUIRE(rope.ToString() ==
+            std::string(1490, 'a') + "bbb" + std::string(1500, 'a'));
+  }
+
+  // "Chunks are slices of the source, not copies"
+  {
+    std::string text(5000, 'q');
+    Rope rope(text);
+    Rope middle = rope.Substr(1000, 3000);
+    std::vector<const char *> rope_chunks;
+    rope.ForEachChunk(
+        [&](std::string_view chunk) { rope_chunks.push_back(chunk.data()); });
+    size_t total = 0;
+    bool shared = false;
+    middle.ForEachChunk([&](std::string_view chunk) {
+      total += chunk.size();
+      for (const char *start : rope_chunks) {
+        shared = shared || (chunk.data() >= start &&
+                            chunk.data() < start + text.size());
+      }
+    });
+    REQUIRE(total == 3000);
+    REQUIRE(shared);
+  }
+
+  // "Random edits agree with std::string and keep the tree balanced"
+  {
+    std::mt19937 gen(7);
+    std::string expected = "start";
+    Rope rope(expected);
+    for (int i = 0; i < 5000; ++i) {
+      size_t pos = gen() % (expected.size() + 1);
+      switch (gen() % 4) {
+      case 0:
+      case 1: {
+        std::string text(gen() % 20 + 1, 'a' + i % 26);
+        expected.insert(pos, text);
+        rope.Insert(pos, text);
+        break;
+      }
+      case 2: {
+        size_t count = gen() % 30;
+        expected.erase(pos, count);
+        rope.Erase(pos, count);
+        break;
+      }
+      case 3: {
+        size_t count = gen() % 100;
+        Rope piece = rope.Substr(pos, count);
+        REQUIRE(piece.ToString() == expected.substr(pos, count));
+        rope.Insert(rope.Size() / 2, piece);
+        expected.insert(expected.size() / 2, expected.substr(pos, count));
+        break;
+      }
+      }
+    }
+    REQUIRE(rope.ToString() == expected);
+    REQUIRE(Balanced(rope));
+    for (size_t i = 0; i < expected.size(); i += 37) {
+      REQUIRE(rope[i] == expected[i]);
+    }
+  }
+}
@@ -440,3 +440,45 @@ void TestDestructorForCorrectType() {
     REQUIRE(B::destructor_called);
   }
 }
+
+struct CountingDelete {
+  void operator()(int *ptr) const {
+    delete ptr;
+    ++calls;
+  }
+
+  static int calls;
+};
+
+int CountingDelete::calls = 0;
+
+void TestCustomDeleter() {
+  // "Deleter is called once"
+  {
+    CountingDelete::calls = 0;
+    {
+      SharedPtr<int> a(new int(1), CountingDelete{});
+      SharedPtr<int> b = a;
+      REQUIRE(a.UseCount() == 2);
+    }
+    REQUIRE(CountingDelete::calls == 1);
+  }
+
+  // "Stateless deleter and allocator take no space"
+  {
+    static_assert(sizeof(DeleterBlock<int, CountingDelete, std::allocator<int>>) ==
+                  sizeof(RawPtrBlock<int>));
+  }
+
+  // "Stateful deleter"
+  {
+    int deleted = 0;
+    {
+      SharedPtr<int> a(new int(1), [&deleted](int *ptr) {
+        delete ptr;
+        ++deleted;
+      });
+    }
+    REQUIRE(deleted == 1);
+  }
+}
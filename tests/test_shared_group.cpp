@@ -0,0 +1,109 @@
+#include "../src/shared/shared_group.h"
+#include "../src/weak/weak.h"
+#include "./my_int.h"
+#include <string>
+
+#define REQUIRE(b)                                                             \
+  {                                                                            \
+    if (!(b)) {                                                                \
+      std::cout << "WRONG" << std::endl;                                       \
+    };                                                                         \
+  }
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct Request {
+  std::string path;
+  int id = 0;
+};
+
+struct Parser {
+  explicit Parser(Request *request) : request{request} {}
+  Request *request;
+};
+
+struct Throwing {
+  Throwing() { throw 1; }
+};
+
+void TestGroup() {
+  // "Members share one control block"
+  {
+    auto [request, parser, counter] = MakeSharedGroup<Request, Parser, MyInt>(
+        std::forward_as_tuple("/index", 7), std::make_tuple(nullptr),
+        std::make_tuple(42));
+
+    REQUIRE(request->path == "/index");
+    REQUIRE(request->id == 7);
+    REQUIRE(parser->request == nullptr);
+    REQUIRE(*counter == 42);
+    REQUIRE(request.UseCount() == 3);
+    REQUIRE(MyInt::AliveCount() == 1);
+  }
+  REQUIRE(MyInt::AliveCount() == 0);
+
+  // "Any member keeps the whole group alive"
+  {
+    SharedPtr<MyInt> last;
+    WeakPtr<Request> weak;
+    {
+      auto [request, value] = MakeSharedGroup<Request, MyInt>();
+      weak = request;
+      last = value;
+    }
+    REQUIRE(!weak.Expired());
+    REQUIRE(MyInt::AliveCount() == 1);
+    last.Reset();
+    REQUIRE(weak.Expired());
+    REQUIRE(MyInt::AliveCount() == 0);
+  }
+
+  // "Contiguous"
+  {
+    auto [a, b] = MakeSharedGroup<MyInt, MyInt>();
+    auto distance = reinterpret_cast<char *>(b.Get()) -
+                    reinterpret_cast<char *>(a.Get());
+    REQUIRE(distance == sizeof(MyInt));
+  }
+
+  // "Failed construction destroys constructed members"
+  {
+    bool thrown = false;
+    try {
+      MakeSharedGroup<MyInt, Throwing>();
+    } catch (int) {
+      thrown = true;
+    }
+    REQUIRE(thrown);
+    REQUIRE(MyInt::AliveCount() == 0);
+  }
+}
+
+void TestBatch() {
+  // "Batch"
+  {
+    std::vector<SharedPtr<MyInt>> batch = MakeSharedBatch<MyInt>(5, 3);
+    REQUIRE(batch.size() == 5);
+    REQUIRE(MyInt::AliveCount() == 5);
+    REQUIRE(*batch[4] == 3);
+    REQUIRE(batch[4].Get() == batch[0].Get() + 4);
+    REQUIRE(batch[0].UseCount() == 5);
+
+    SharedPtr<MyInt> survivor = batch[2];
+    batch.clear();
+    REQUIRE(MyInt::AliveCount() == 5);
+    survivor.Reset();
+    REQUIRE(MyInt::AliveCount() == 0);
+  }
+
+  // "Failed construction"
+  {
+    bool thrown = false;
+    try {
+      MakeSharedBatch<Throwing>(3);
+    } catch (int) {
+      thrown = true;
+    }
+    REQUIRE(thrown);
+  }
+}
@@ -0,0 +1,137 @@
+#include "../src/shared/shared_span.h"
+#include "./my_int.h"
+#include <numeric>
+#include <string_view>
+
+#define REQUIRE(b)                                                             \
+  {                                                                            \
+    if (!(b)) {                                                                \
+      std::cout << "WRONG" << std::endl;                                       \
+    };                                                                         \
+  }
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::string_view AsString(const SharedBytes &bytes) {
+  return {reinterpret_cast<const char *>(bytes.Data()), bytes.Size()};
+}
+
+void TestMakeSharedArray() {
+  // "Value initialized"
+  {
+    SharedPtr<int[]> a = MakeShared<int[]>(10);
+    int sum = 0;
+    for (size_t i = 0; i < 10; ++i) {
+      sum += a[i];
+    }
+    REQUIRE(sum == 0);
+    REQUIRE(a.UseCount() == 1);
+  }
+
+  // "Lifetime"
+  {
+    {
+      SharedPtr<MyInt[]> a = MakeShared<MyInt[]>(5, MyInt(3));
+      REQUIRE(MyInt::AliveCount() == 5);
+      REQUIRE(a[4] == 3);
+    }
+    REQUIRE(MyInt::AliveCount() == 0);
+  }
+
+  // "Alignment"
+  {
+    struct alignas(16) Wide {
+      double x, y;
+    };
+    SharedPtr<Wide[]> a = MakeShared<Wide[]>(3);
+    REQUIRE(reinterpret_cast<uintptr_t>(a.Get()) % 16 == 0);
+  }
+
+  // "For overwrite"
+  {
+    SharedPtr<MyInt[]> a = MakeSharedForOverwrite<MyInt[]>(3);
+    REQUIRE(MyInt::AliveCount() == 3);
+    a.Reset();
+    REQUIRE(MyInt::AliveCount() == 0);
+  }
+
+  // "Raw array pointer uses delete[]"
+  {
+    { SharedPtr<MyInt[]> a(new MyInt[4]); }
+    REQUIRE(MyInt::AliveCount() == 0);
+  }
+}
+
+void TestSlicing() {
+  // "Subspan shares the buffer"
+  {
+    SharedSpan<int> span = MakeSharedSpan<int>(10);
+    std::iota(span.begin(), span.end(), 0);
+
+    SharedSpan<int> middle = span.Subspan(3, 4);
+    REQUIRE(middle.Size() == 4);
+    REQUIRE(middle.Data() == span.Data() + 3);
+    REQUIRE(middle[0] == 3);
+    REQUIRE(span.UseCount() == 2);
+
+    SharedSpan<int> tail = middle.Last(2);
+    REQUIRE(tail[1] == 6);
+    REQUIRE(tail.First(1)[0] == 5);
+    REQUIRE(span.Subspan(10).Empty());
+  }
+
+  // "Slice keeps the buffer alive"
+  {
+    SharedSpan<MyInt> slice;
+    {
+      SharedPtr<MyInt[]> buffer = MakeShared<MyInt[]>(8, MyInt(1));
+      slice = SharedSpan<MyInt>(buffer, 8).Subspan(6);
+    }
+    REQUIRE(MyInt::AliveCount() == 8);
+    REQUIRE(slice.Size() == 2);
+    REQUIRE(slice[1] == 1);
+
+    slice.Reset();
+    REQUIRE(MyInt::AliveCount() == 0);
+  }
+
+  // "Move"
+  {
+    SharedSpan<int> a = MakeSharedSpan<int>(3);
+    SharedSpan<int> b = std::move(a);
+    REQUIRE(a.Empty());
+    REQUIRE(a.Data() == nullptr);
+    REQUIRE(b.Size() == 3);
+    REQUIRE(b.UseCount() == 1);
+  }
+}
+
+void TestSharedBytes() {
+  // "Copy in and slice"
+  {
+    std::string_view text = "header:payload";
+    SharedBytes bytes = MakeSharedBytes(std::as_bytes(std::span(text)));
+
+    REQUIRE(AsString(bytes) == text);
+    REQUIRE(AsString(bytes.First(6)) == "header");
+    REQUIRE(AsString(bytes.Subspan(7)) == "payload");
+  }
+
+  // "Mutable to const"
+  {
+    SharedSpan<std::byte> writable = MakeSharedSpan<std::byte>(4);
+    writable[0] = std::byte{'a'};
+
+    SharedBytes frozen = writable;
+    REQUIRE(frozen[0] == std::byte{'a'});
+    REQUIRE(frozen.UseCount() == 2);
+  }
+
+  // "Span for overwrite"
+  {
+    SharedSpan<std::byte> buffer = MakeSharedSpanForOverwrite<std::byte>(3);
+    REQUIRE(buffer.Size() == 3);
+    std::memcpy(buffer.Data(), "abc", 3);
+    REQUIRE(AsString(SharedBytes(buffer)) == "abc");
+  }
+}
@@ -0,0 +1,140 @@
+#include "../src/slot_map/slot_map.h"
+#include "./my_int.h"
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#define REQUIRE(b)                                                             \
+  {                                                                            \
+    if (!(b)) {                                                                \
+      std::cout << "WRONG" << std::endl;                                       \
+    };                                                                         \
+  }
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct Throwing {
+  Throwing() = default;
+  explicit Throwing(int) { throw 1; }
+};
+
+void TestSlotMap() {
+  // "Insert and lookup"
+  {
+    SlotMap<std::string> map;
+    auto a = map.Insert("a");
+    auto b = map.Emplace(3, 'b');
+    REQUIRE(map.Size() == 2);
+    REQUIRE(map.Contains(a));
+    REQUIRE(map[a] == "a");
+    REQUIRE(*map.Get(b) == "bbb");
+    REQUIRE(!(a == b));
+    static_assert(sizeof(SlotHandle<std::string>) == 8);
+  }
+
+  // "Default handle is null"
+  {
+    SlotMap<int> map;
+    map.Insert(1);
+    SlotHandle<int> handle;
+    REQUIRE(!handle);
+    REQUIRE(!map.Contains(handle));
+    REQUIRE(map.Get(handle) == nullptr);
+  }
+
+  // "Erased handles expire, others stay valid"
+  {
+    SlotMap<int> map;
+    std::vector<SlotHandle<int>> handles;
+    for (int i = 0; i < 10; ++i) {
+      handles.push_back(map.Insert(i));
+    }
+    REQUIRE(map.Erase(handles[0]));
+    REQUIRE(map.Erase(handles[5]));
+    REQUIRE(!map.Erase(handles[5]));
+    REQUIRE(map.Size() == 8);
+    REQUIRE(!map.Contains(handles[0]));
+    REQUIRE(map.Get(handles[5]) == nullptr);
+    for (int i : {1, 2, 3, 4, 6, 7, 8, 9}) {
+      REQUIRE(map[handles[i]] == i);
+    }
+  }
+
+  // "Reused slot does not revive old handles"
+  {
+    SlotMap<int> map;
+    auto old = map.Insert(1);
+    map.Erase(old);
+    auto fresh = map.Insert(2);
+    REQUIRE(fresh.index == old.index);
+    REQUIRE(fresh.generation != old.generation);
+    REQUIRE(!map.Contains(old));
+    REQUIRE(map[fresh] == 2);
+  }
+
+  // "Elements stay contiguous"
+  {
+    SlotMap<int> map;
+    std::vector<SlotHandle<int>> handles;
+    for (int i = 0; i < 100; ++i) {
+      handles.push_back(map.Insert(i));
+    }
+    for (int i = 0; i < 100; i += 2) {
+      map.Erase(handles[i]);
+    }
+    REQUIRE(map.Values().size() == 50);
+    int sum = 0;
+    for (int value : map) {
+      sum += value;
+    }
+    REQUIRE(sum == 2500);
+    for (size_t i = 0; i < map.Size(); ++i) {
+      REQUIRE(map[map.HandleAt(i)] == map.Values()[i]);
+    }
+    map.ShrinkToFit();
+    REQUIRE(map[handles[51]] == 51);
+  }
+
+  // "Clear invalidates handles and destroys elements"
+  {
+    SlotMap<MyInt> map;
+    auto handle = map.Emplace(5);
+    map.Emplace(6);
+    REQUIRE(MyInt::AliveCount() == 2);
+    map.Clear();
+    REQUIRE(map.Empty());
+    REQUIRE(!map.Contains(handle));
+    REQUIRE(MyInt::AliveCount() == 0);
+    auto again = map.Emplace(7);
+    REQUIRE(map[again] == 7);
+  }
+  REQUIRE(MyInt::AliveCount() == 0);
+
+  // "Move-only elements"
+  {
+    SlotMap<std::unique_ptr<int>> map;
+    auto a = map.Insert(std::make_unique<int>(1));
+    auto b = map.Insert(std::make_unique<int>(2));
+    map.Erase(a);
+    REQUIRE(*map[b] == 2);
+  }
+
+  // "Throwing constructor keeps the map consistent"
+  {
+    SlotMap<Throwing> map;
+    auto handle = map.Emplace();
+    bool thrown = false;
+    try {
+      map.Emplace(1);
+    } catch (int) {
+      thrown = true;
+    }
+    REQUIRE(thrown);
+    REQUIRE(map.Size() == 1);
+    REQUIRE(map.Contains(handle));
+    auto next = map.Emplace();
+    REQUIRE(map.Contains(next));
+    REQUIRE(map.Size() == 2);
+  }
+}
@@ -0,0 +1,201 @@
+#include "../src/intrusive/intrusive.h"
+#include "../src/tagged/pointer_union.h"
+#include "../src/tagged/tagged_ptr.h"
+#include "./my_int.h"
+#include <iostream>
+
+#define REQUIRE(b)                                                             \
+  {                                                                            \
+    if (!(b)) {                                                                \
+      std::cout << "WRONG" << std::endl;                                       \
+    };                                                                         \
+  }
+
+////////////////////////////////////////////////////////////////////////////////
+
+enum NodeFlags : uintptr_t { kRed = 1, kDirty = 2 };
+
+struct TreeNode {
+  explicit TreeNode(int value) : value{value} {}
+  MyInt value;
+  // Color and dirty flag live in the child pointers
+  TaggedUniquePtr<TreeNode, 2> left;
+  TaggedUniquePtr<TreeNode, 2> right;
+};
+
+struct Shared : SimpleRefCounted<Shared> {
+  explicit Shared(int value) : value{value} {}
+  MyInt value;
+};
+
+struct alignas(8) Leaf {
+  int value = 1;
+};
+
+struct alignas(8) Branch {
+  int children = 2;
+};
+
+struct alignas(8) Extra {};
+
+struct CountingDeleter {
+  void operator()(Shared *ptr) {
+    ++calls;
+    delete ptr;
+  }
+  int calls = 0;
+};
+
+void TestTaggedPtr() {
+  static_assert(FreeLowBits<char>() == 0);
+  static_assert(FreeLowBits<uint64_t>() == 3);
+  static_assert(sizeof(TaggedPtr<uint64_t, 3>) == sizeof(void *));
+
+  // "Pointer and tag are independent"
+  {
+    uint64_t value = 5;
+    TaggedPtr<uint64_t, 3> ptr(&value, 6);
+    REQUIRE(ptr.Get() == &value);
+    REQUIRE(ptr.GetTag() == 6);
+    REQUIRE(*ptr == 5);
+
+    ptr.SetTag(1);
+    REQUIRE(ptr.Get() == &value);
+    REQUIRE(ptr.GetTag() == 1);
+
+    uint64_t other = 7;
+    ptr.SetPointer(&other);
+    REQUIRE(*ptr == 7);
+    REQUIRE(ptr.GetTag() == 1);
+
+    ptr.SetPointer(nullptr);
+    REQUIRE(!ptr);
+    REQUIRE(ptr.GetTag() == 1);
+  }
+
+  // "Comparison"
+  {
+    uint64_t value = 0;
+    REQUIRE((TaggedPtr<uint64_t, 2>(&value, 1) == TaggedPtr<uint64_t, 2>(&value, 1)));
+    REQUIRE((TaggedPtr<uint64_t, 2>(&value, 1) != TaggedPtr<uint64_t, 2>(&value, 2)));
+    REQUIRE((TaggedPtr<uint64_t, 2>() == nullptr));
+  }
+}
+
+void TestTaggedIntrusivePtr() {
+  static_assert(sizeof(TaggedIntrusivePtr<Shared, 3>) == sizeof(void *));
+
+  // "Refcount semantics with tags"
+  {
+    TaggedIntrusivePtr<Shared, 3> ptr(new Shared(1), 5);
+    REQUIRE(ptr.UseCount() == 1);
+    REQUIRE(ptr.GetTag() == 5);
+
+    TaggedIntrusivePtr<Shared, 3> copy = ptr;
+    REQUIRE(ptr.UseCount() == 2);
+    REQUIRE(copy.GetTag() == 5);
+    copy.SetTag(2);
+    REQUIRE(ptr.GetTag() == 5);
+
+    TaggedIntrusivePtr<Shared, 3> moved = std::move(copy);
+    REQUIRE(!copy);
+    REQUIRE(moved.GetTag() == 2);
+    REQUIRE(ptr.UseCount() == 2);
+
+    moved.Reset();
+    REQUIRE(moved.GetTag() == 2);
+    REQUIRE(ptr.UseCount() == 1);
+
+    ptr.Reset(new Shared(2));
+    REQUIRE(ptr->value == 2);
+    REQUIRE(ptr.GetTag() == 5);
+    REQUIRE(MyInt::AliveCount() == 1);
+
+    ptr = moved;
+    REQUIRE(MyInt::AliveCount() == 0);
+    REQUIRE(ptr.GetTag() == 2);
+  }
+}
+
+void TestTaggedUniquePtr() {
+  static_assert(sizeof(TaggedUniquePtr<TreeNode, 2>) == sizeof(void *));
+
+  // "Flags live in the child pointers"
+  {
+    TreeNode root(0);
+    root.left = TaggedUniquePtr<TreeNode, 2>(new TreeNode(1), kRed);
+    root.right = TaggedUniquePtr<TreeNode, 2>(new TreeNode(2), kRed | kDirty);
+    root.left->left = TaggedUniquePtr<TreeNode, 2>(new TreeNode(3));
+    REQUIRE(root.left.GetTag() == kRed);
+    REQUIRE(root.right.GetTag() == (kRed | kDirty));
+    REQUIRE(root.left->left->value == 3);
+    REQUIRE(MyInt::AliveCount() == 4);
+
+    root.right.SetTag(0);
+    REQUIRE(root.right->value == 2);
+
+    TaggedUniquePtr<TreeNode, 2> detached = std::move(root.left);
+    REQUIRE(!root.left);
+    REQUIRE(detached.GetTag() == kRed);
+
+    root.right = nullptr;
+    REQUIRE(MyInt::AliveCount() == 3);
+  }
+  REQUIRE(MyInt::AliveCount() == 0);
+
+  // "Custom deleter"
+  {
+    TaggedUniquePtr<Shared, 3, CountingDeleter> ptr(new Shared(1), 3, CountingDeleter());
+    ptr.Reset(new Shared(2));
+    REQUIRE(ptr.GetDeleter().calls == 1);
+    REQUIRE(ptr.GetTag() == 3);
+    Shared *raw = ptr.Release();
+    REQUIRE(!ptr);
+    delete raw;
+  }
+  REQUIRE(MyInt::AliveCount() == 0);
+}
+
+void TestPointerUnion() {
+  static_assert(sizeof(PointerUnion<Leaf *, Branch *>) == sizeof(void *));
+
+  // "Discriminated by the low bits"
+  {
+    Leaf leaf;
+    Branch branch;
+    PointerUnion<Leaf *, Branch *> node = &leaf;
+    REQUIRE(node.Is<Leaf *>());
+    REQUIRE(!node.Is<Branch *>());
+    REQUIRE(node.Get<Leaf *>()->value == 1);
+    REQUIRE(node.DynCast<Branch *>() == nullptr);
+    REQUIRE(node.Index() == 0);
+
+    node = &branch;
+    REQUIRE(node.Is<Branch *>());
+    REQUIRE(node.Get<Branch *>()->children == 2);
+    REQUIRE(node.DynCast<Leaf *>() == nullptr);
+    REQUIRE(node.Index() == 1);
+  }
+
+  // "Null and comparison"
+  {
+    Leaf leaf;
+    PointerUnion<Leaf *, Branch *> empty;
+    REQUIRE(!empty);
+    REQUIRE(empty == nullptr);
+    PointerUnion<Leaf *, Branch *> a = &leaf;
+    PointerUnion<Leaf *, Branch *> b = &leaf;
+    REQUIRE(a == b);
+    REQUIRE(a != empty);
+  }
+
+  // "More alternatives and const pointees"
+  {
+    Extra extra;
+    const Leaf leaf;
+    PointerUnion<const Leaf *, Branch *, Extra *> node = &extra;
+    REQUIRE(node.Index() == 2);
+    node = &leaf;
+    REQUIRE(node.Get<const Leaf *>()->value == 1);
+  }
+}
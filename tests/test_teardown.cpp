@@ -0,0 +1,139 @@
+#include "../src/intrusive/intrusive.h"
+#include "../src/teardown/teardown.h"
+#include "../src/weak/weak.h"
+#include <atomic>
+#include <iostream>
+#include <vector>
+
+#define REQUIRE(b)                                                             \
+  {                                                                            \
+    if (!(b)) {                                                                \
+      std::cout << "WRONG" << std::endl;                                       \
+    };                                                                         \
+  }
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Deep enough to overflow the stack with recursive destructors
+constexpr int kLength = 1'000'000;
+
+struct Counted {
+  Counted() { ++alive; }
+  Counted(const Counted &) { ++alive; }
+  ~Counted() { --alive; }
+  static inline std::atomic<int> alive = 0;
+};
+
+struct IntrusiveNode : SimpleRefCounted<IntrusiveNode, IterativeDelete>, Counted {
+  IntrusivePtr<IntrusiveNode> next;
+};
+
+struct UniqueNode : Counted {
+  IterativeUniquePtr<UniqueNode> left;
+  IterativeUniquePtr<UniqueNode> right;
+};
+
+struct SharedNode : Counted {
+  SharedPtr<SharedNode> next;
+  WeakPtr<SharedNode> prev;
+};
+
+IterativeUniquePtr<UniqueNode> MakeTree(int depth) {
+  IterativeUniquePtr<UniqueNode> node = MakeUniqueIterative<UniqueNode>();
+  if (depth > 1) {
+    node->left = MakeTree(depth - 1);
+    node->right = MakeTree(depth - 1);
+  }
+  return node;
+}
+
+void TestIterativeTeardown() {
+  // "Long intrusive chain"
+  {
+    IntrusivePtr<IntrusiveNode> head = MakeIntrusive<IntrusiveNode>();
+    IntrusiveNode *tail = head.Get();
+    for (int i = 1; i < kLength; ++i) {
+      tail->next = MakeIntrusive<IntrusiveNode>();
+      tail = tail->next.Get();
+    }
+    REQUIRE(Counted::alive == kLength);
+    head.Reset();
+    REQUIRE(Counted::alive == 0);
+    REQUIRE(TeardownQueue::Local().PendingCount() == 0);
+  }
+
+  // "Shared tails are only released"
+  {
+    IntrusivePtr<IntrusiveNode> head = MakeIntrusive<IntrusiveNode>();
+    head->next = MakeIntrusive<IntrusiveNode>();
+    head->next->next = MakeIntrusive<IntrusiveNode>();
+    IntrusivePtr<IntrusiveNode> middle = head->next;
+    head.Reset();
+    REQUIRE(Counted::alive == 2);
+    REQUIRE(middle.UseCount() == 1);
+    middle.Reset();
+    REQUIRE(Counted::alive == 0);
+  }
+
+  // "Long SharedPtr chain with back links"
+  {
+    SharedPtr<SharedNode> head = MakeSharedIterative<SharedNode>();
+    SharedPtr<SharedNode> tail = head;
+    for (int i = 1; i < kLength; ++i) {
+      SharedPtr<SharedNode> node = MakeSharedIterative<SharedNode>();
+      node->prev = tail;
+      tail->next = node;
+      tail = node;
+    }
+    WeakPtr<SharedNode> last = tail;
+    tail.Reset();
+    REQUIRE(Counted::alive == kLength);
+    head.Reset();
+    REQUIRE(Counted::alive == 0);
+    REQUIRE(last.Expired());
+  }
+
+  // "Tree of unique pointers"
+  {
+    IterativeUniquePtr<UniqueNode> root = MakeTree(16);
+    REQUIRE(Counted::alive == (1 << 16) - 1);
+    root.Reset();
+    REQUIRE(Counted::alive == 0);
+  }
+
+  // "Long unique chain"
+  {
+    IterativeUniquePtr<UniqueNode> head = MakeUniqueIterative<UniqueNode>();
+    UniqueNode *tail = head.Get();
+    for (int i = 1; i < kLength; ++i) {
+      tail->right = MakeUniqueIterative<UniqueNode>();
+      tail = tail->right.Get();
+    }
+    head = nullptr;
+    REQUIRE(Counted::alive == 0);
+  }
+}
+
+void TestParallelTeardown() {
+  // "Independent subtrees on several threads"
+  {
+    IterativeUniquePtr<UniqueNode> root = MakeTree(16);
+    std::vector<IterativeUniquePtr<UniqueNode>> subtrees;
+    subtrees.push_back(std::move(root->left));
+    subtrees.push_back(std::move(root->right));
+    root.Reset();
+    subtrees.push_back(MakeTree(10));
+    DestroyInParallel(std::move(subtrees), 4);
+    REQUIRE(subtrees.empty());
+    REQUIRE(Counted::alive == 0);
+  }
+
+  // "Single thread and empty input"
+  {
+    std::vector<IterativeUniquePtr<UniqueNode>> subtrees;
+    DestroyInParallel(std::move(subtrees), 4);
+    subtrees.push_back(MakeTree(4));
+    DestroyInParallel(std::move(subtrees), 1);
+    REQUIRE(Counted::alive == 0);
+  }
+}
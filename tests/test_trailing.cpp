@@ -0,0 +1,162 @@
+#include "../src/trailing/shared_string.h"
+#include "../src/trailing/trailing.h"
+#include "../src/weak/weak.h"
+#include "./my_int.h"
+#include <string>
+#include <unordered_set>
+
+#define REQUIRE(b)                                                             \
+  {                                                                            \
+    if (!(b)) {                                                                \
+      std::cout << "WRONG" << std::endl;                                       \
+    };                                                                         \
+  }
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct Packet : WithTrailing<Packet, uint32_t> {
+  explicit Packet(int id) : id{id} {}
+  int id;
+};
+
+struct Values : WithTrailing<Values, MyInt> {
+  MyInt header{-1};
+};
+
+struct ThrowingHeader : WithTrailing<ThrowingHeader, MyInt> {
+  ThrowingHeader() { throw 1; }
+};
+
+struct Node : SimpleRefCounted<Node, TrailingDelete>, WithTrailing<Node, MyInt> {
+  explicit Node(std::string name) : name{std::move(name)} {}
+  std::string name;
+};
+
+void TestMakeSharedWithTrailing() {
+  // "Trailing elements follow the object"
+  {
+    SharedPtr<Packet> packet = MakeSharedWithTrailing<Packet>(5, 7);
+    REQUIRE(packet->id == 7);
+    REQUIRE(packet->Trailing().size() == 5);
+    for (uint32_t value : packet->Trailing()) {
+      REQUIRE(value == 0);
+    }
+
+    auto *begin = reinterpret_cast<char *>(packet->Trailing().data());
+    REQUIRE(begin >= reinterpret_cast<char *>(packet.Get() + 1));
+    REQUIRE(reinterpret_cast<uintptr_t>(begin) % alignof(uint32_t) == 0);
+
+    packet->Trailing()[4] = 42;
+    const Packet &view = *packet;
+    REQUIRE(view.Trailing()[4] == 42);
+  }
+
+  // "Zero trailing elements"
+  {
+    SharedPtr<Packet> packet = MakeSharedWithTrailing<Packet>(0, 1);
+    REQUIRE(packet->Trailing().empty());
+  }
+
+  // "Trailing elements are destroyed with the object"
+  {
+    WeakPtr<Values> weak;
+    {
+      SharedPtr<Values> values = MakeSharedWithTrailing<Values>(3);
+      REQUIRE(MyInt::AliveCount() == 4);
+      REQUIRE(values->header == -1);
+      weak = values;
+    }
+    REQUIRE(weak.Expired());
+    REQUIRE(MyInt::AliveCount() == 0);
+  }
+
+  // "Throwing constructor"
+  {
+    bool thrown = false;
+    try {
+      MakeSharedWithTrailing<ThrowingHeader>(4);
+    } catch (int) {
+      thrown = true;
+    }
+    REQUIRE(thrown);
+    REQUIRE(MyInt::AliveCount() == 0);
+  }
+}
+
+struct PlainDeleteNode : SimpleRefCounted<PlainDeleteNode>,
+                         WithTrailing<PlainDeleteNode, int> {};
+
+void TestMakeIntrusiveWithTrailing() {
+  // "Only TrailingDelete objects are accepted"
+  {
+    static_assert(UsesTrailingDelete<Node>::value);
+    static_assert(!UsesTrailingDelete<PlainDeleteNode>::value);
+  }
+
+  // "Intrusive object with trailing elements"
+  {
+    IntrusivePtr<Node> node = MakeIntrusiveWithTrailing<Node>(2, "root");
+    REQUIRE(node->name == "root");
+    REQUIRE(node.UseCount() == 1);
+    REQUIRE(node->Trailing().size() == 2);
+    REQUIRE(MyInt::AliveCount() == 2);
+
+    IntrusivePtr<Node> copy = node;
+    REQUIRE(node.UseCount() == 2);
+    node.Reset();
+    REQUIRE(MyInt::AliveCount() == 2);
+    copy.Reset();
+    REQUIRE(MyInt::AliveCount() == 0);
+  }
+}
+
+void TestSharedString() {
+  // "Empty string"
+  {
+    SharedString str;
+    REQUIRE(str.Empty());
+    REQUIRE(str.Size() == 0);
+    REQUIRE(str.View().empty());
+    REQUIRE(std::string(str.CStr()).empty());
+    REQUIRE(str.UseCount() == 0);
+    REQUIRE(SharedString("") == str);
+  }
+
+  // "Characters and terminator"
+  {
+    SharedString str("hello");
+    REQUIRE(str.Size() == 5);
+    REQUIRE(str.View() == "hello");
+    REQUIRE(std::string(str.CStr()) == "hello");
+    REQUIRE(str.CStr()[5] == '\0');
+  }
+
+  // "Copies share the characters"
+  {
+    SharedString str(std::string(100, 'x'));
+    SharedString copy = str;
+    REQUIRE(str.UseCount() == 2);
+    REQUIRE(copy.CStr() == str.CStr());
+    copy.Reset();
+    REQUIRE(str.UseCount() == 1);
+  }
+
+  // "Comparison"
+  {
+    SharedString a("abc");
+    SharedString b(std::string("abc"));
+    SharedString c("abd");
+    REQUIRE(a == b);
+    REQUIRE(a != c);
+    REQUIRE(a < c);
+    REQUIRE(c > b);
+  }
+
+  // "Hashing through the view"
+  {
+    std::unordered_set<std::string_view> set;
+    SharedString str("key");
+    set.insert(str);
+    REQUIRE(set.count("key") == 1);
+  }
+}
@@ -1,6 +1,7 @@
 #include "../src/unique/deleters.h"
 #include "../src/unique/unique.h"
 #include "./my_int.h"
+#include <memory>
 #include <vector>
 
 #define REQUIRE(b)                                                             \
@@ -532,3 +533,79 @@ void TestUpcasts() {
     s2 = std::move(s);
   }
 }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct TreeNode {
+  constexpr explicit TreeNode(int value) : value{value} {}
+
+  int value;
+  UniquePtr<TreeNode> left;
+  UniquePtr<TreeNode> right;
+};
+
+constexpr UniquePtr<TreeNode> BuildTree(int depth, int value) {
+  UniquePtr<TreeNode> node(new TreeNode(value));
+  if (depth > 0) {
+    node->left = BuildTree(depth - 1, 2 * value);
+    node->right = BuildTree(depth - 1, 2 * value + 1);
+  }
+  return node;
+}
+
+constexpr int SumTree(const TreeNode *node) {
+  if (node == nullptr) {
+    return 0;
+  }
+  return node->value + SumTree(node->left.Get()) + SumTree(node->right.Get());
+}
+
+consteval int BuildAndSumTree(int depth) {
+  UniquePtr<TreeNode> root = BuildTree(depth, 1);
+  return SumTree(root.Get());
+}
+
+consteval bool ModifyAtCompileTime() {
+  UniquePtr<TreeNode> a(new TreeNode(1));
+  UniquePtr<TreeNode> b(new TreeNode(2));
+
+  a.Swap(b);
+  if (a->value != 2 || b->value != 1) {
+    return false;
+  }
+
+  TreeNode *raw = a.Release();
+  if (a || raw->value != 2) {
+    return false;
+  }
+  b.Reset(raw);
+
+  a = std::move(b);
+  return !b && a->value == 2;
+}
+
+consteval int SumArrayAtCompileTime() {
+  UniquePtr<int[]> a(new int[4]{1, 2, 3, 4});
+  UniquePtr<int[]> b(new int[2]{10, 20});
+
+  a.Swap(b);
+  int sum = a[0] + a[1] + b[3];
+
+  b.Reset(new int[1]{100});
+  sum += b[0];
+
+  int *raw = a.Release();
+  delete[] raw;
+  return sum;
+}
+
+void TestConstexpr() {
+  // "Pointer graph is built and destroyed at compile time"
+  { static_assert(BuildAndSumTree(4) == 31 * 32 / 2); }
+
+  // "Modifiers"
+  { static_assert(ModifyAtCompileTime()); }
+
+  // "Array specialization"
+  { static_assert(SumArrayAtCompileTime() == 134); }
+}
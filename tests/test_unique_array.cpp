@@ -0,0 +1,130 @@
+#include "../src/unique/unique_array.h"
+#include "./my_int.h"
+#include <cstdint>
+#include <numeric>
+
+#define REQUIRE(b)                                                             \
+  {                                                                            \
+    if (!(b)) {                                                                \
+      std::cout << "WRONG" << std::endl;                                       \
+    };                                                                         \
+  }
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename T> bool IsAligned(const T *ptr, size_t align) {
+  return reinterpret_cast<uintptr_t>(ptr) % align == 0;
+}
+
+void TestConstruction() {
+  // "Default value"
+  {
+    UniqueArray<int> a;
+    REQUIRE(a.Data() == nullptr);
+    REQUIRE(a.Size() == 0);
+    REQUIRE(a.Empty());
+  }
+
+  // "Value initialized"
+  {
+    UniqueArray<int> a(100);
+    REQUIRE(a.Size() == 100);
+    REQUIRE(std::accumulate(a.begin(), a.end(), 0) == 0);
+  }
+
+  // "Filled"
+  {
+    UniqueArray<double> a(10, 1.5);
+    REQUIRE(std::accumulate(a.begin(), a.end(), 0.0) == 15.0);
+  }
+
+  // "Lifetime"
+  {
+    {
+      UniqueArray<MyInt> a(10, MyInt(1));
+      REQUIRE(MyInt::AliveCount() == 10);
+      REQUIRE(a[9] == 1);
+    }
+    REQUIRE(MyInt::AliveCount() == 0);
+  }
+
+  // "Uninitialized"
+  {
+    auto a = UniqueArray<float>::Uninitialized(33);
+    for (size_t i = 0; i < a.Size(); ++i) {
+      a[i] = i;
+    }
+    REQUIRE(a.Size() == 33);
+    REQUIRE(a[32] == 32.f);
+  }
+}
+
+void TestAlignment() {
+  // "Default alignment"
+  {
+    for (size_t size = 1; size < 100; size += 7) {
+      UniqueArray<float> a(size);
+      REQUIRE(IsAligned(a.Data(), kDefaultArrayAlignment));
+    }
+  }
+
+  // "Custom alignment"
+  {
+    UniqueArray<char, 4096> page(10);
+    REQUIRE(IsAligned(page.Data(), 4096));
+  }
+
+  // "Sizeof"
+  {
+    static_assert(sizeof(UniqueArray<int>) == 2 * sizeof(void *));
+  }
+}
+
+void TestModifiers() {
+  // "Move"
+  {
+    UniqueArray<MyInt> a(5, MyInt(1));
+    UniqueArray<MyInt> b(3, MyInt(2));
+    MyInt *p = a.Data();
+
+    b = std::move(a);
+    REQUIRE(MyInt::AliveCount() == 5);
+    REQUIRE(b.Data() == p);
+    REQUIRE(b.Size() == 5);
+    REQUIRE(a.Size() == 0);
+    REQUIRE(a.Data() == nullptr);
+  }
+  REQUIRE(MyInt::AliveCount() == 0);
+
+  // "Reset"
+  {
+    UniqueArray<MyInt> a(5, MyInt(1));
+    a.Reset();
+    REQUIRE(MyInt::AliveCount() == 0);
+    REQUIRE(a.Empty());
+  }
+
+  // "Swap"
+  {
+    UniqueArray<int> a(5, 1);
+    UniqueArray<int> b(3, 2);
+    a.Swap(b);
+    REQUIRE(a.Size() == 3);
+    REQUIRE(a[0] == 2);
+    REQUIRE(b.Size() == 5);
+    REQUIRE(b[0] == 1);
+  }
+}
+
+void TestSpan() {
+  // "Span"
+  {
+    UniqueArray<int> a(4, 7);
+    std::span<int> s = a.Span();
+    REQUIRE(s.data() == a.Data());
+    REQUIRE(s.size() == 4);
+
+    std::span<const int> cs = a;
+    REQUIRE(cs[3] == 7);
+  }
+}
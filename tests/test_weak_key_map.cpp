@@ -0,0 +1,222 @@
+#include "../src/weak/owner.h"
+#include "../src/weak/weak_key_map.h"
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define REQUIRE(b)                                                             \
+  {                                                                            \
+    if (!(b)) {                                                                \
+      std::cout << "WRONG" << std::endl;                                       \
+    };                                                                         \
+  }
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct OwnedPair {
+  int first = 1;
+  int second = 2;
+};
+
+struct MapValue {
+  static inline int alive = 0;
+
+  MapValue() { ++alive; }
+  MapValue(const MapValue &) { ++alive; }
+  MapValue(MapValue &&) noexcept { ++alive; }
+  MapValue &operator=(const MapValue &) = default;
+  MapValue &operator=(MapValue &&) = default;
+  ~MapValue() { --alive; }
+};
+
+void TestOwnerComparison() {
+  // "Aliasing pointers share the owner"
+  {
+    SharedPtr<OwnedPair> pair = MakeShared<OwnedPair>();
+    SharedPtr<int> second(pair, &pair->second);
+    WeakPtr<OwnedPair> weak = pair;
+    REQUIRE(second.Get() != static_cast<void *>(pair.Get()));
+    REQUIRE(pair.OwnerEqual(second));
+    REQUIRE(second.OwnerEqual(weak));
+    REQUIRE(!pair.OwnerBefore(second) && !second.OwnerBefore(pair));
+    REQUIRE(pair.OwnerHash() == second.OwnerHash());
+    REQUIRE(weak.OwnerHash() == second.OwnerHash());
+  }
+
+  // "Distinct objects are ordered one way"
+  {
+    SharedPtr<int> a = MakeShared<int>(1);
+    SharedPtr<int> b = MakeShared<int>(1);
+    REQUIRE(!a.OwnerEqual(b));
+    REQUIRE(a.OwnerBefore(b) != b.OwnerBefore(a));
+    REQUIRE(OwnerLess()(a, b) == a.OwnerBefore(b));
+  }
+
+  // "Expired WeakPtr keeps its owner"
+  {
+    SharedPtr<int> a = MakeShared<int>(1);
+    WeakPtr<int> weak = a;
+    size_t hash = weak.OwnerHash();
+    SharedPtr<int> b = MakeShared<int>(2);
+    bool before = weak.OwnerBefore(b);
+    a.Reset();
+    REQUIRE(weak.Expired());
+    REQUIRE(weak.OwnerHash() == hash);
+    REQUIRE(weak.OwnerBefore(b) == before);
+    REQUIRE(!weak.OwnerEqual(b));
+  }
+
+  // "Empty pointers are equal"
+  {
+    SharedPtr<int> empty;
+    WeakPtr<double> weak;
+    REQUIRE(empty.OwnerEqual(weak));
+    REQUIRE(OwnerEqual()(weak, empty));
+    REQUIRE(empty.OwnerHash() == weak.OwnerHash());
+  }
+
+  // "Ordered map keyed by WeakPtr"
+  {
+    std::map<WeakPtr<int>, std::string, OwnerLess> names;
+    SharedPtr<int> a = MakeShared<int>(1);
+    SharedPtr<int> b = MakeShared<int>(1);
+    names[WeakPtr<int>(a)] = "a";
+    names[WeakPtr<int>(b)] = "b";
+    REQUIRE(names.size() == 2);
+    REQUIRE(names.find(a)->second == "a");
+    a.Reset();
+    std::erase_if(names, [](const auto &item) { return item.first.Expired(); });
+    REQUIRE(names.size() == 1);
+    REQUIRE(names.find(b)->second == "b");
+  }
+
+  // "Hashed map keyed by WeakPtr"
+  {
+    std::unordered_map<WeakPtr<int>, int, OwnerHash, OwnerEqual> counts;
+    SharedPtr<int> a = MakeShared<int>(1);
+    SharedPtr<int> alias(a, a.Get());
+    ++counts[WeakPtr<int>(a)];
+    ++counts[WeakPtr<int>(alias)];
+    REQUIRE(counts.size() == 1);
+    REQUIRE(counts.find(a)->second == 2);
+    REQUIRE(counts.contains(alias));
+    REQUIRE(!counts.contains(MakeShared<int>(1)));
+  }
+}
+
+void TestWeakKeyMap() {
+  // "Set, find and erase"
+  {
+    WeakKeyMap<int, std::string> map;
+    SharedPtr<int> a = MakeShared<int>(1);
+    SharedPtr<int> b = MakeShared<int>(1);
+    REQUIRE(map.Find(a) == nullptr);
+    REQUIRE(map.Set(a, "a"));
+    REQUIRE(map.Set(WeakPtr<int>(b), "b"));
+    REQUIRE(!map.Set(a, "aa"));
+    REQUIRE(map.EntryCount() == 2);
+    REQUIRE(*map.Find(a) == "aa");
+    REQUIRE(*map.Find(WeakPtr<int>(b)) == "b");
+    REQUIRE(map.Erase(a));
+    REQUIRE(!map.Erase(a));
+    REQUIRE(!map.Contains(a));
+    REQUIRE(map.Contains(b));
+    REQUIRE(map.EntryCount() == 1);
+  }
+
+  // "Keys are not kept alive"
+  {
+    WeakKeyMap<int, int> map;
+    SharedPtr<int> a = MakeShared<int>(1);
+    WeakPtr<int> weak = a;
+    map.Set(a, 1);
+    REQUIRE(a.UseCount() == 1);
+    a.Reset();
+    REQUIRE(weak.Expired());
+    REQUIRE(map.Find(weak) == nullptr);
+    REQUIRE(!map.Set(weak, 2));
+  }
+
+  // "Aliasing pointers find the entry"
+  {
+    WeakKeyMap<OwnedPair, int> map;
+    SharedPtr<OwnedPair> pair = MakeShared<OwnedPair>();
+    map.Set(pair, 7);
+    SharedPtr<int> second(pair, &pair->second);
+    REQUIRE(map.Find(second) != nullptr && *map.Find(second) == 7);
+  }
+
+  // "Full table is swept before it grows"
+  {
+    WeakKeyMap<int, MapValue> map;
+    std::vector<SharedPtr<int>> keys;
+    // Three quarters of the first table
+    for (int i = 0; i < 12; ++i) {
+      keys.push_back(MakeShared<int>(i));
+      map.Set(keys.back(), MapValue());
+    }
+    REQUIRE(MapValue::alive == 12);
+    WeakPtr<int> weak = keys[0];
+    keys.erase(keys.begin(), keys.begin() + 8);
+    REQUIRE(map.EntryCount() == 12);
+    SharedPtr<int> key = MakeShared<int>(12);
+    map.Set(key, MapValue());
+    REQUIRE(map.EntryCount() == 5);
+    REQUIRE(MapValue::alive == 5);
+    // The block of a removed key is released too
+    REQUIRE(weak.Expired());
+    bool found = map.Contains(key);
+    for (const SharedPtr<int> &other : keys) {
+      found = found && map.Contains(other);
+    }
+    REQUIRE(found);
+    keys.clear();
+    map.Purge();
+    REQUIRE(map.EntryCount() == 1);
+    REQUIRE(MapValue::alive == 1);
+  }
+  REQUIRE(MapValue::alive == 0);
+
+  // "ForEach visits live entries"
+  {
+    WeakKeyMap<int, int> map;
+    SharedPtr<int> a = MakeShared<int>(1);
+    SharedPtr<int> b = MakeShared<int>(2);
+    map.Set(a, 10);
+    map.Set(b, 20);
+    b.Reset();
+    int sum = 0;
+    map.ForEach([&sum](const SharedPtr<int> &key, int &value) {
+      sum += *key + value;
+      ++value;
+    });
+    REQUIRE(sum == 11);
+    REQUIRE(*map.Find(a) == 11);
+  }
+
+  // "Churn keeps the table small"
+  {
+    WeakKeyMap<int, int> map;
+    std::vector<SharedPtr<int>> live;
+    for (int i = 0; i < 100000; ++i) {
+      live.push_back(MakeShared<int>(i));
+      map.Set(live.back(), i);
+      if (live.size() > 100) {
+        live.erase(live.begin());
+      }
+    }
+    bool found = true;
+    for (const SharedPtr<int> &key : live) {
+      int *value = map.Find(key);
+      found = found && value != nullptr && *value == *key;
+    }
+    REQUIRE(found);
+    REQUIRE(map.EntryCount() < 1000);
+    map.Purge();
+    REQUIRE(map.EntryCount() == live.size());
+    map.Clear();
+    REQUIRE(map.EntryCount() == 0);
+    REQUIRE(map.Find(live[0]) == nullptr);
+  }
+}